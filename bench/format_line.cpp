@@ -0,0 +1,94 @@
+// Line formatting before and after the per-second timestamp cache. "before" is the former
+// formatLine: localtime_r and put_time with the user format on every line, built with an
+// ostringstream. "after" is the built-in layout as the logger formats it today
+// (loggy_detail::PatternFormatter::classic, backed by loggy_detail::TimestampCache). Both take
+// the time with system_clock::now() per line, like a log call does.
+// Usage: format_line [lines=2000000]
+// Build and run: see bench/README.md
+#include "../loggy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const kMessage = "request 4711 user=alice took 1.25ms ok=true";
+const char* const kFunction = "handleRequest";
+const char* const kFile = "server.cpp";
+
+// The formatLine of the logger before the cache (its ostringstream path)
+std::string formatLineBefore(LogLevel level, const char* func, const char* file, int line, const std::string& msg,
+    std::chrono::system_clock::time_point now, std::thread::id threadId, bool includeThreadId,
+    const std::string& timeFormat) {
+    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+    std::tm tm{};
+    localtime_r(&now_c, &tm);
+    std::ostringstream oss;
+    oss << std::put_time(&tm, timeFormat.c_str()) << " [" << loggy_level_name(level) << "]";
+    if (includeThreadId) oss << " [T:" << threadId << "]";
+    if (file && *file) oss << " [" << file << ":" << line << "]";
+    if (func && *func) oss << " " << func << " -> ";
+    else oss << " ";
+    oss << msg;
+    return oss.str();
+}
+
+template <typename Body>
+double nsPerLine(long lines, Body&& body) {
+    const auto begin = Clock::now();
+    for (long i = 0; i < lines; ++i) body();
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / static_cast<double>(lines);
+}
+
+void compare(const char* timeFormat, long lines) {
+    std::size_t sink = 0;   // keeps the results alive
+
+    const std::string format = timeFormat;
+    const std::string msg = kMessage;
+    const std::thread::id threadId = std::this_thread::get_id();
+    const double before = nsPerLine(lines, [&] {
+        sink += formatLineBefore(LogLevel::INFO, kFunction, kFile, 42, msg,
+            std::chrono::system_clock::now(), threadId, true, format).size();
+    });
+
+    const auto layout = loggy_detail::PatternFormatter::classic(timeFormat);
+    const loggy_detail::ThreadTag& tag = loggy_detail::currentThreadTag();
+    std::string out;
+    const double after = nsPerLine(lines, [&] {
+        loggy_detail::LineFields fields;
+        fields.level = LogLevel::INFO;
+        fields.time = std::chrono::system_clock::now();
+        fields.threadId = tag.id;
+        fields.threadText = tag.view();
+        fields.file = kFile;
+        fields.line = 42;
+        fields.func = kFunction;
+        fields.msg = kMessage;
+        out.clear();
+        layout->format(out, fields, true);
+        sink += out.size();
+    });
+
+    std::printf("%-24s %12.1f %12.1f %9.1fx   %s\n", timeFormat, before, after, before / after, out.c_str());
+    if (sink == 0) std::printf("no output\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long lines = argc > 1 ? std::atol(argv[1]) : 2000000;
+    std::printf("%ld lines per run, ns per line\n\n", lines);
+    std::printf("%-24s %12s %12s %10s   %s\n", "time format", "before", "after", "speedup", "line");
+    compare("%Y-%m-%d %H:%M:%S", lines);
+    compare("%H:%M:%S", lines);
+    compare("%d/%b/%Y:%H:%M:%S %z", lines);
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Cost of putting a formatted line into a LogFileSink: LogFileBackend::Posix (write() on an
+// O_APPEND descriptor) against the std::ofstream path (LogFileBackend::Stream), once with every
+// line written on its own (setBufferSize(0)) and once with the default batch buffer. Reports
+// ns per line and, on Linux when perf events are permitted (kernel.perf_event_paranoid <= 2),
+// user-space instructions per line; the kernel side of write() is the same for both.
+// Usage: posix_vs_stream [directory=.] [lines=500000]
+// Build and run: see bench/README.md
+#include "../loggy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view kLine = "2024-01-01 12:00:00.123 [INFO] [T:4711] worker -> request 4711 user=alice took 1.25ms\n";
+
+// User-space instructions retired by this thread; stop() returns -1 where that is not available
+class InstructionCounter {
+public:
+    InstructionCounter() {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~InstructionCounter() {
+#if defined(__linux__)
+        if (m_fd >= 0) ::close(m_fd);
+#endif
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (m_fd < 0) return;
+        ::ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+#if defined(__linux__)
+        if (m_fd < 0) return -1;
+        ::ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long value = 0;
+        if (::read(m_fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) return -1;
+        return value;
+#else
+        return -1;
+#endif
+    }
+
+private:
+    int m_fd = -1;
+};
+
+void run(const char* name, const std::filesystem::path& file, LogFileBackend backend, bool unbuffered, long lines) {
+    LogFileSink sink(backend);
+    LogRotationPolicy noRotation;
+    noRotation.maxFileSize = 0;
+    sink.setRotationPolicy(noRotation);
+    if (unbuffered) sink.setBufferSize(0);
+    sink.open(file);
+
+    for (long i = 0; i < lines / 10; ++i) sink.write(LogLevel::INFO, kLine);  // warm-up
+    sink.flush();
+
+    InstructionCounter instructions;
+    const auto begin = Clock::now();
+    instructions.start();
+    for (long i = 0; i < lines; ++i) sink.write(LogLevel::INFO, kLine);
+    sink.flush();
+    const long long count = instructions.stop();
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / static_cast<double>(lines);
+    const LogFileStats stats = sink.stats();
+    sink.close();
+    std::filesystem::remove(file);
+
+    char perLine[32] = "n/a";
+    if (count >= 0) std::snprintf(perLine, sizeof(perLine), "%.0f", static_cast<double>(count) / static_cast<double>(lines));
+    std::printf("%-22s %10.1f %14s %12.5f\n", name, ns, perLine, stats.syscallsPerLine());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? argv[1] : ".";
+    const long lines = argc > 2 ? std::atol(argv[2]) : 500000;
+    const std::filesystem::path file = dir / "loggy_bench_posix.log";
+
+    std::printf("%ld lines of %zu bytes into %s\n\n", lines, kLine.size(), file.string().c_str());
+    std::printf("%-22s %10s %14s %12s\n", "", "ns/line", "instr/line", "writes/line");
+    run("stream, every line", file, LogFileBackend::Stream, true, lines);
+    run("posix, every line", file, LogFileBackend::Posix, true, lines);
+    run("stream, batched", file, LogFileBackend::Stream, false, lines);
+    run("posix, batched", file, LogFileBackend::Posix, false, lines);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Async producer scaling: the same number of log calls split over 1..N threads, once through
+// the shared MPSC queue and once through per-thread SPSC rings (LogQueueMode::PerThread).
+// Reports the cost of a log call on the calling threads and the end-to-end rate including
+// formatting on the backend. Lines go to a sink that discards them, so the disk is not measured.
+// Usage: thread_scaling [maxThreads=128] [totalLines=2000000]
+// Build and run: see bench/README.md
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class NullSink : public LogSink {
+public:
+    void write(LogLevel, std::string_view line) override { m_bytes += line.size(); }
+
+private:
+    std::uint64_t m_bytes = 0;
+};
+
+struct Result {
+    double callNs = 0;      // mean time per log call on a producer thread
+    double linesPerSec = 0; // from the first call until everything was written
+};
+
+Result run(LogQueueMode mode, int threads, long totalLines) {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    logger.addSink(std::make_shared<NullSink>());
+    logger.enableAsync(true, mode);
+
+    const long perThread = totalLines / threads;
+    std::latch start(threads + 1);
+    std::vector<double> busyNs(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            logger.log(LogLevel::INFO, "bench", "warm-up");   // registers the ring outside the timing
+            start.arrive_and_wait();
+            const auto begin = Clock::now();
+            for (long i = 0; i < perThread; ++i)
+                logger.log(LogLevel::INFO, "bench", "request ", i, " from worker ", t, " took ", 0.25 * i, "ms");
+            busyNs[t] = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+        });
+    }
+    start.arrive_and_wait();
+    const auto begin = Clock::now();
+    for (auto& w : workers) w.join();
+    logger.flush();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    logger.shutdown();
+
+    Result r;
+    for (double ns : busyNs) r.callNs += ns;
+    r.callNs /= static_cast<double>(perThread) * threads;
+    r.linesPerSec = static_cast<double>(perThread) * threads / elapsed;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int maxThreads = argc > 1 ? std::atoi(argv[1]) : 128;
+    const long totalLines = argc > 2 ? std::atol(argv[2]) : 2000000;
+
+    std::printf("%u hardware threads, %ld lines per run\n\n", std::thread::hardware_concurrency(), totalLines);
+    std::printf("%8s | %-25s | %-25s\n", "", "shared queue", "per-thread rings");
+    std::printf("%8s | %12s %12s | %12s %12s\n", "threads", "ns/call", "Mlines/s", "ns/call", "Mlines/s");
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        const Result shared = run(LogQueueMode::Shared, threads, totalLines);
+        const Result rings = run(LogQueueMode::PerThread, threads, totalLines);
+        std::printf("%8d | %12.1f %12.2f | %12.1f %12.2f\n", threads,
+            shared.callNs, shared.linesPerSec / 1e6, rings.callNs, rings.linesPerSec / 1e6);
+    }
+    return 0;
+}
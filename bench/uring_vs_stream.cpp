@@ -0,0 +1,98 @@
+// Log file throughput and log call latency under sustained load: LogFileBackend::Uring against
+// the std::ofstream path (LogFileBackend::Stream), in sync and async mode. Several threads log
+// as fast as they can into one file; every call is timed, so a backend that blocks in write()
+// or fdatasync shows up in the tail latencies. Rotation is off, so the file grows to the full
+// amount (threads x lines x ~110 bytes).
+// Usage: uring_vs_stream [directory=.] [threads=4] [linesPerThread=250000]
+// Build and run: see bench/README.md
+#include "../loggy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <latch>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double nsPerLine = 0;       // wall time from the first call until flush() returned
+    double p50 = 0, p99 = 0, p999 = 0, max = 0;   // single log calls, ns
+    double writesPerLine = 0;
+};
+
+Result run(const std::filesystem::path& file, LogFileBackend backend, bool async, int threads, long lines) {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.fileSink()->setBackend(backend);
+    LogRotationPolicy noRotation;
+    noRotation.maxFileSize = 0;
+    logger.fileSink()->setRotationPolicy(noRotation);
+    logger.setLogPath(file);
+    if (async) logger.enableAsync(true);
+
+    std::latch start(threads + 1);
+    std::vector<std::vector<std::uint32_t>> latencies(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<std::uint32_t>& mine = latencies[t];
+            mine.reserve(static_cast<std::size_t>(lines));
+            start.arrive_and_wait();
+            for (long i = 0; i < lines; ++i) {
+                const auto begin = Clock::now();
+                logger.log(LogLevel::INFO, "bench", "request ", i, " from worker ", t, " took ", 0.25 * i, "ms status=ok");
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+                mine.push_back(static_cast<std::uint32_t>(std::min<long long>(ns, UINT32_MAX)));
+            }
+        });
+    }
+    start.arrive_and_wait();
+    const auto begin = Clock::now();
+    for (auto& w : workers) w.join();
+    logger.flush();
+    const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    const LogFileStats stats = logger.fileSink()->stats();
+    logger.shutdown();
+    std::filesystem::remove(file);
+
+    std::vector<std::uint32_t> all;
+    for (auto& v : latencies) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    auto at = [&](double q) { return static_cast<double>(all[static_cast<std::size_t>(q * static_cast<double>(all.size() - 1))]); };
+
+    Result r;
+    r.nsPerLine = elapsed / static_cast<double>(all.size());
+    r.p50 = at(0.5);
+    r.p99 = at(0.99);
+    r.p999 = at(0.999);
+    r.max = all.back();
+    r.writesPerLine = stats.syscallsPerLine();
+    return r;
+}
+
+void print(const char* name, const Result& r) {
+    std::printf("%-14s %10.1f %10.0f %10.0f %10.0f %12.0f %12.5f\n", name, r.nsPerLine, r.p50, r.p99, r.p999, r.max, r.writesPerLine);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::filesystem::path dir = argc > 1 ? argv[1] : ".";
+    const int threads = argc > 2 ? std::atoi(argv[2]) : 4;
+    const long lines = argc > 3 ? std::atol(argv[3]) : 250000;
+    const std::filesystem::path file = dir / "loggy_bench_uring.log";
+
+    std::printf("%d threads x %ld lines into %s\n\n", threads, lines, file.string().c_str());
+    std::printf("%-14s %10s %10s %10s %10s %12s %12s\n", "", "ns/line", "p50 ns", "p99 ns", "p99.9 ns", "max ns", "writes/line");
+    for (bool async : { false, true }) {
+        print(async ? "stream async" : "stream sync", run(file, LogFileBackend::Stream, async, threads, lines));
+        print(async ? "uring async" : "uring sync", run(file, LogFileBackend::Uring, async, threads, lines));
+    }
+    return 0;
+}
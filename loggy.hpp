@@ -8,64 +8,3240 @@
 #include <iomanip>
 #include <ctime>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <type_traits>
 #include <filesystem>
 #include <iostream>
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
 #include <source_location>
-#if __cpp_lib_format >= 202207L
-    #include <format>
+#include <span>
+#include <limits>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <cstdio>
+#elif defined(__linux__)
+    #include <unistd.h>
+    #include <sys/syscall.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+#endif
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/uio.h>
+    #define LOGGY_HAS_IO_URING 1
+#else
+    #define LOGGY_HAS_IO_URING 0
+#endif
+
+#if defined(LOGGY_COMPRESS_WITH_ZLIB) && LOGGY_COMPRESS_WITH_ZLIB
+    #include <zlib.h>
+#endif
+
+#ifndef LOGGY_MAX_LOG_FILE_SIZE
+#   define LOGGY_MAX_LOG_FILE_SIZE (5ull * 1024ull * 1024ull) // 5 MB; default of LogRotationPolicy::maxFileSize
+#endif
+
+#ifndef LOGGY_ROTATE_BACKUPS
+#   define LOGGY_ROTATE_BACKUPS 3                             // keep N old files: file.1, file.2, ... (LogRotationPolicy::maxBackups)
+#endif
+
+#ifndef LOGGY_CHECK_INTERVAL
+#   define LOGGY_CHECK_INTERVAL 200                           // unused: file sizes are counted, rotation is exact
+#endif
+
+#ifndef LOGGY_MIN_LEVEL
+#  define LOGGY_MIN_LEVEL 0                                   // 0=DEBUG, 1=INFO, 2=WARN, 3=ERR, 4=FATAL
+#endif
+
+#ifndef LOGGY_COLORIZE_CONSOLE
+#  define LOGGY_COLORIZE_CONSOLE 1
+#endif
+
+#ifndef LOGGY_BEST_EFFORT_TRYLOCK
+#  define LOGGY_BEST_EFFORT_TRYLOCK 0                         // set to 1 to skip logs when mutex contended
+#endif
+
+#ifndef LOGGY_ASYNC_QUEUE_SIZE
+#  define LOGGY_ASYNC_QUEUE_SIZE 8192                         // records in the async queue (rounded up to a power of two)
+#endif
+
+#ifndef LOGGY_THREAD_QUEUE_SIZE
+#  define LOGGY_THREAD_QUEUE_SIZE 1024                        // records per thread ring in LogQueueMode::PerThread
+#endif
+
+#ifndef LOGGY_ASYNC_IDLE_SLEEP_US
+#  define LOGGY_ASYNC_IDLE_SLEEP_US 1000                      // backend poll interval while the queue is empty
+#endif
+
+#ifndef LOGGY_INLINE_ARGS_SIZE
+#  define LOGGY_INLINE_ARGS_SIZE 128                          // argument bytes kept inside a record before spilling to the heap
+#endif
+
+#ifndef LOGGY_OVERFLOW_GROW_LIMIT
+#  define LOGGY_OVERFLOW_GROW_LIMIT (16ull * 1024ull * 1024ull) // bytes LogOverflowPolicy::Grow may spill beyond the queues
+#endif
+
+#ifndef LOGGY_FILE_BATCH_BYTES
+#  define LOGGY_FILE_BATCH_BYTES (64u * 1024u)               // file sink: write once this many bytes are pending
+#endif
+
+#ifndef LOGGY_FILE_BATCH_LATENCY_US
+#  define LOGGY_FILE_BATCH_LATENCY_US 1000                    // file sink: ... or once the oldest pending line is this old
+#endif
+
+#ifndef LOGGY_MMAP_CHUNK_SIZE
+#  define LOGGY_MMAP_CHUNK_SIZE (64ull * 1024ull * 1024ull)   // LogFileBackend::Mmap: file grows and is mapped in chunks of this size
+#endif
+
+#ifndef LOGGY_URING_BUFFERS
+#  define LOGGY_URING_BUFFERS 8                               // LogFileBackend::Uring: registered buffers (writes in flight)
+#endif
+
+#ifndef LOGGY_URING_BUFFER_SIZE
+#  define LOGGY_URING_BUFFER_SIZE (256u * 1024u)              // LogFileBackend::Uring: bytes per registered buffer
+#endif
+
+#ifndef LOGGY_URING_SYNC_INTERVAL_MS
+#  define LOGGY_URING_SYNC_INTERVAL_MS 1000                   // LogFileBackend::Uring: fdatasync at most this often (0 = never)
+#endif
+
+#ifndef LOGGY_CONSOLE_BUFFER_SIZE
+#  define LOGGY_CONSOLE_BUFFER_SIZE (16u * 1024u)             // LogAnsiConsoleSink: bytes buffered for a pipe before writing
+#endif
+
+#ifndef LOGGY_RING_LINE_SIZE
+#  define LOGGY_RING_LINE_SIZE 256                            // LogRingSink: bytes kept per line (longer lines are cut)
+#endif
+
+#ifndef LOGGY_SOCKET_BUFFER_SIZE
+#  define LOGGY_SOCKET_BUFFER_SIZE (256u * 1024u)             // LogSocketSink: pending bytes kept while the collector is slow or away
+#endif
+
+#ifndef LOGGY_SOCKET_BATCH_LATENCY_US
+#  define LOGGY_SOCKET_BATCH_LATENCY_US 1000                  // LogSocketSink: send once the oldest pending line is this old
+#endif
+
+#ifndef LOGGY_HANDLER_BATCH_LINES
+#  define LOGGY_HANDLER_BATCH_LINES 512                       // batch handler: call it once this many lines are pending
+#endif
+
+#ifndef LOGGY_HANDLER_BATCH_LATENCY_US
+#  define LOGGY_HANDLER_BATCH_LATENCY_US 1000                 // batch handler: ... or once the oldest pending line is this old
+#endif
+
+#ifndef LOGGY_COMPRESS_WITH_ZLIB
+#  define LOGGY_COMPRESS_WITH_ZLIB 0                          // 1: compressed backups are gzip (.gz, link zlib); 0: built-in LZ4 frames (.lz4)
+#endif
+
+#ifndef LOGGY_DROP_REPORT_INTERVAL_MS
+#  define LOGGY_DROP_REPORT_INTERVAL_MS 1000                  // at most one "N messages dropped" line per interval
+#endif
+
+enum class LogLevel {
+    DEBUG = 0,
+    INFO,
+    WARN,
+    ERR,
+    FATAL
+};
+
+// Compile-time filter
+constexpr bool loggy_enabled(LogLevel lvl) {
+    return static_cast<int>(lvl) >= LOGGY_MIN_LEVEL;
+}
+
+constexpr const char* loggy_level_name(LogLevel level) noexcept {
+    switch (level) {
+    case LogLevel::DEBUG: return "DEBUG";
+    case LogLevel::INFO:  return "INFO";
+    case LogLevel::WARN:  return "WARN";
+    case LogLevel::ERR:   return "ERROR";
+    case LogLevel::FATAL: return "FATAL";
+    default:              return "UNKNOWN";
+    }
+}
+
+// How async records travel from producer threads to the backend
+enum class LogQueueMode {
+    Shared,     // one bounded multi-producer queue
+    PerThread   // one single-producer ring per logging thread, polled by the backend
+};
+
+// How a LogFileSink puts bytes into its file
+enum class LogFileBackend {
+    Stream,     // std::ofstream, one write per batch (portable default)
+    Mmap,       // preallocated chunks mapped into memory, lines are copied in (POSIX; else Stream)
+    Uring,      // asynchronous writes and fdatasync through io_uring (Linux; else Stream)
+    Posix       // open()/write() on an O_APPEND descriptor, no stream layer (POSIX; else Stream)
+};
+
+// Time based rotation of a LogFileSink (in addition to the size limit)
+enum class LogRotateInterval {
+    Never,      // size only; the path is used as given
+    Hourly,     // new file at every full hour (local time)
+    Daily       // new file at midnight (local time)
+};
+
+// Socket type of a LogSocketSink
+enum class LogSocketMode {
+    Datagram,   // SOCK_DGRAM, one datagram per line
+    Stream      // SOCK_STREAM, newline framed
+};
+
+// What a producer does when its async queue is full
+enum class LogOverflowPolicy {
+    Block,       // wait for the backend to free a slot (default)
+    DropNewest,  // discard the record being logged
+    DropOldest,  // evict the oldest queued record to make room
+    Grow         // spill into an unbounded list until the memory cap, then drop newest
+};
+
+// Function or source file name given to a log call. const char arrays (__FUNCTION__,
+// __FILE__, literals) have static storage and are kept by pointer, as is a name marked
+// persistent() (e.g. from std::source_location). Any other `const char*` is copied into an
+// async record, so it may point into a temporary.
+class LogSourceName {
+public:
+    constexpr LogSourceName() noexcept = default;
+    constexpr LogSourceName(std::nullptr_t) noexcept {}
+
+    template <typename C, std::size_t N>
+        requires std::is_same_v<C, const char>
+    constexpr LogSourceName(C (&name)[N]) noexcept : m_name(name), m_persistent(true) {}
+
+    template <typename P>
+        requires std::is_same_v<P, const char*> || std::is_same_v<P, char*>
+    constexpr LogSourceName(P name) noexcept : m_name(name) {}
+
+    // For a name that outlives every record, so it need not be copied
+    static constexpr LogSourceName persistent(const char* name) noexcept {
+        LogSourceName result(name);
+        result.m_persistent = true;
+        return result;
+    }
+
+    [[nodiscard]] constexpr const char* c_str() const noexcept { return m_name; }
+    [[nodiscard]] constexpr bool isPersistent() const noexcept { return m_persistent || !m_name; }
+
+private:
+    const char* m_name = nullptr;
+    bool m_persistent = false;
+};
+
+// A log argument kept by pointer instead of copied into the record; made by loggy::lit()
+struct LogLiteral {
+    const char* text;
+};
+
+namespace loggy {
+
+    // Marks a string literal (or another const char array with static storage) as safe to log
+    // by pointer: LOG(INFO, loggy::lit("a long fixed text ..."), value). Other arguments are
+    // copied. It is consteval, so a local array, whose address is no constant, does not compile.
+    template <std::size_t N>
+    consteval LogLiteral lit(const char (&text)[N]) noexcept {
+        return LogLiteral{ text };
+    }
+
+} // namespace loggy
+
+// -----------------------------
+// Lock-free bounded queues
+// -----------------------------
+namespace loggy_detail {
+
+    inline constexpr std::size_t kCacheLine = 64;
+
+    inline std::size_t roundUpPow2(std::size_t v) noexcept {
+        std::size_t p = 2;
+        while (p < v) p <<= 1;
+        return p;
+    }
+
+    // Bounded multi-producer queue (D. Vyukov): every cell carries a sequence number,
+    // so a producer claims a slot with a single CAS on the enqueue position and never
+    // takes a lock. Values are only moved from when a slot was actually claimed.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(std::size_t capacity)
+            : m_mask(roundUpPow2(capacity) - 1), m_cells(new Cell[m_mask + 1]) {
+            for (std::size_t i = 0; i <= m_mask; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        bool tryPush(T&& value) {
+            Cell* cell = nullptr;
+            std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return false; // full
+                }
+                else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(value);
+            cell->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(T& out) {
+            Cell* cell = nullptr;
+            std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                const std::size_t seq = cell->seq.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return false; // empty
+                }
+                else {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            out = std::move(cell->data);
+            cell->seq.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_mask + 1; }
+
+        // Positions claimed by producers / taken by consumers so far (a claimed cell may still be filling)
+        [[nodiscard]] std::size_t pushed() const noexcept { return m_enqueuePos.load(std::memory_order_seq_cst); }
+        [[nodiscard]] std::size_t popped() const noexcept { return m_dequeuePos.load(std::memory_order_acquire); }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> seq{ 0 };
+            T data{};
+        };
+
+        const std::size_t m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+        alignas(kCacheLine) std::atomic<std::size_t> m_enqueuePos{ 0 };
+        alignas(kCacheLine) std::atomic<std::size_t> m_dequeuePos{ 0 };
+    };
+
+    // Single-producer/single-consumer ring. Each side keeps a private copy of the other
+    // side's index and only re-reads the shared one when the cached value says full/empty,
+    // so in steady state producer and consumer do not share a written cache line.
+    template <typename T>
+    class SpscRing {
+    public:
+        explicit SpscRing(std::size_t capacity)
+            : m_mask(roundUpPow2(capacity) - 1), m_slots(new T[m_mask + 1]) {
+        }
+
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // producer side
+        bool tryPush(T&& value) {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_headCache > m_mask) {
+                m_headCache = m_head.load(std::memory_order_acquire);
+                if (tail - m_headCache > m_mask) return false; // full
+            }
+            m_slots[tail & m_mask] = std::move(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer side
+        bool tryPop(T& out) {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tailCache) {
+                m_tailCache = m_tail.load(std::memory_order_acquire);
+                if (head == m_tailCache) return false; // empty
+            }
+            out = std::move(m_slots[head & m_mask]);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+        // Records pushed / popped so far
+        [[nodiscard]] std::size_t pushed() const noexcept { return m_tail.load(std::memory_order_acquire); }
+        [[nodiscard]] std::size_t popped() const noexcept { return m_head.load(std::memory_order_acquire); }
+
+    private:
+        const std::size_t m_mask;
+        std::unique_ptr<T[]> m_slots;
+        alignas(kCacheLine) std::atomic<std::size_t> m_tail{ 0 };
+        std::size_t m_headCache = 0;            // producer-owned
+        alignas(kCacheLine) std::atomic<std::size_t> m_head{ 0 };
+        std::size_t m_tailCache = 0;            // consumer-owned
+    };
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Deferred argument capture
+// -----------------------------
+namespace loggy_detail {
+
+    // The calling thread only copies raw argument bytes; turning them into text happens
+    // when the record is written (on the backend thread in async mode).
+    //   arithmetic        -> value bytes, printed like operator<< would
+    //   LogLiteral        -> pointer (loggy::lit: a literal with static storage)
+    //   char[N], const char[N], const char*, std::string, std::string_view -> length + bytes
+    //                        (a const char array may be a local, so it is copied too)
+    //   anything else     -> formatted with operator<< right away, stored as string
+    // Arg is the type deduced by a forwarding reference (Logger::log takes `Args&&`), so a
+    // literal arrives as `const char(&)[N]` and a mutable buffer as `char(&)[N]`.
+    struct LiteralArg {};
+
+    // Argument bytes of one record. Up to LOGGY_INLINE_ARGS_SIZE bytes live inside the
+    // record (and thus inside the queue slot), so a typical log call allocates nothing.
+    class ArgBuffer {
+    public:
+        ArgBuffer() noexcept = default;
+        ArgBuffer(ArgBuffer&& other) noexcept { take(other); }
+        ArgBuffer& operator=(ArgBuffer&& other) noexcept {
+            if (this != &other) take(other);
+            return *this;
+        }
+        ArgBuffer(const ArgBuffer&) = delete;
+        ArgBuffer& operator=(const ArgBuffer&) = delete;
+
+        [[nodiscard]] const char* data() const noexcept { return m_heap ? m_heap.get() : m_inline; }
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_heap ? m_heapCapacity : sizeof(m_inline); }
+
+        void append(const char* bytes, std::size_t n) {
+            if (m_size + n > capacity()) grow(m_size + n);
+            std::memcpy((m_heap ? m_heap.get() : m_inline) + m_size, bytes, n);
+            m_size += n;
+        }
+
+    private:
+        char m_inline[LOGGY_INLINE_ARGS_SIZE];
+        std::unique_ptr<char[]> m_heap;
+        std::size_t m_heapCapacity = 0;
+        std::size_t m_size = 0;
+
+        void grow(std::size_t needed) {
+            const std::size_t cap = std::max(needed, capacity() * 2);
+            std::unique_ptr<char[]> bigger(new char[cap]);
+            std::memcpy(bigger.get(), data(), m_size);
+            m_heap = std::move(bigger);
+            m_heapCapacity = cap;
+        }
+
+        void take(ArgBuffer& other) noexcept {
+            m_size = other.m_size;
+            if (other.m_heap) {
+                m_heap = std::move(other.m_heap);
+                m_heapCapacity = other.m_heapCapacity;
+            }
+            else {
+                m_heap.reset();
+                std::memcpy(m_inline, other.m_inline, m_size);
+            }
+            other.m_size = 0;
+        }
+    };
+
+    template <typename Arg>
+    constexpr bool isLiteral() {
+        return std::is_same_v<std::decay_t<Arg>, LogLiteral>;
+    }
+
+    template <typename D>
+    constexpr bool isCharType() {
+        return std::is_same_v<D, char> || std::is_same_v<D, signed char> || std::is_same_v<D, unsigned char>;
+    }
+
+    // How an argument of type Arg is stored in the record
+    template <typename Arg, typename D = std::decay_t<Arg>>
+    using StoredArg = std::conditional_t<isLiteral<Arg>(), LiteralArg,
+        std::conditional_t<std::is_arithmetic_v<D>, D, std::string_view>>;
+
+    static_assert(std::is_same_v<StoredArg<LogLiteral>, LiteralArg>, "loggy::lit() is stored by pointer");
+    static_assert(std::is_same_v<StoredArg<const char(&)[8]>, std::string_view>, "const char arrays are copied");
+    static_assert(std::is_same_v<StoredArg<char(&)[8]>, std::string_view>, "mutable char buffers are copied");
+
+    template <typename T>
+    inline void appendRaw(ArgBuffer& buf, const T& value) {
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline void appendText(ArgBuffer& buf, std::string_view text) {
+        appendRaw(buf, static_cast<std::uint32_t>(text.size()));
+        buf.append(text.data(), text.size());
+    }
+
+    template <typename T>
+    inline T readRaw(const char*& p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    template <typename Arg>
+    inline void encodeArg(ArgBuffer& buf, const std::remove_reference_t<Arg>& value) {
+        using D = std::decay_t<Arg>;
+        using S = StoredArg<Arg>;
+        if constexpr (std::is_same_v<S, LiteralArg>) {
+            appendRaw(buf, value.text);
+        }
+        else if constexpr (std::is_arithmetic_v<S>) {
+            appendRaw(buf, static_cast<S>(value));
+        }
+        else if constexpr (std::is_array_v<std::remove_reference_t<Arg>>) {
+            appendText(buf, std::string_view(value)); // char buffer: copy up to the terminator
+        }
+        else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            appendText(buf, value ? std::string_view(value) : std::string_view());
+        }
+        else if constexpr (std::is_convertible_v<const D&, std::string_view>) {
+            appendText(buf, std::string_view(value));
+        }
+        else {
+            std::ostringstream oss;
+            oss << value;
+            appendText(buf, oss.str());
+        }
+    }
+
+    template <typename S>
+    inline void decodeArg(const char*& p, std::string& out) {
+        if constexpr (std::is_same_v<S, LiteralArg>) {
+            out += readRaw<const char*>(p);
+        }
+        else if constexpr (std::is_same_v<S, std::string_view>) {
+            const auto n = readRaw<std::uint32_t>(p);
+            out.append(p, n);
+            p += n;
+        }
+        else if constexpr (std::is_same_v<S, bool>) {
+            out += readRaw<bool>(p) ? '1' : '0';
+        }
+        else if constexpr (isCharType<S>()) {
+            out += static_cast<char>(readRaw<S>(p));
+        }
+        else if constexpr (std::is_integral_v<S>) {
+            char tmp[24];
+            const auto res = std::to_chars(tmp, tmp + sizeof(tmp), readRaw<S>(p));
+            out.append(tmp, res.ptr);
+        }
+        else {
+            // Same as the default ostream float formatting (%g, precision 6)
+            char tmp[64];
+            const auto res = std::to_chars(tmp, tmp + sizeof(tmp), readRaw<S>(p), std::chars_format::general, 6);
+            out.append(tmp, res.ptr);
+        }
+    }
+
+    // Appends the text of all arguments encoded by encodeArgs<Args...>
+    template <typename... Stored>
+    void formatArgs([[maybe_unused]] const char* p, [[maybe_unused]] std::string& out) {
+        (decodeArg<Stored>(p, out), ...);
+    }
+
+    using FormatArgsFn = void (*)(const char*, std::string&);
+
+    // Formatter for arguments written back to back (stream-style LOG)
+    template <typename... Args>
+    inline constexpr FormatArgsFn concatArgs = &formatArgs<StoredArg<Args>...>;
+
+    // Args as deduced by a forwarding reference (see StoredArg)
+    template <typename... Args>
+    inline void encodeArgs(ArgBuffer& buf, const std::remove_reference_t<Args>&... args) {
+        (encodeArg<Args>(buf, args), ...);
+    }
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Compile-time format strings
+// -----------------------------
+namespace loggy_detail {
+
+    // A `{}` format string is parsed once at compile time into its unescaped literal text
+    // and one segment per literal run; formatting is then segment copies interleaved with
+    // the arguments. Only `{}` placeholders and the `{{` / `}}` escapes are accepted.
+    struct FormatSegment {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    struct FormatInfo {
+        bool valid = true;
+        std::size_t placeholders = 0;
+        std::size_t textLength = 0;
+    };
+
+    constexpr FormatInfo scanFormat(std::string_view fmt, char* text = nullptr, FormatSegment* segments = nullptr) {
+        FormatInfo info;
+        std::size_t segStart = 0;
+        auto emit = [&](char c) {
+            if (text) text[info.textLength] = c;
+            ++info.textLength;
+        };
+        auto closeSegment = [&] {
+            if (segments) {
+                segments[info.placeholders] = { static_cast<std::uint32_t>(segStart),
+                    static_cast<std::uint32_t>(info.textLength - segStart) };
+            }
+        };
+        for (std::size_t i = 0; i < fmt.size(); ++i) {
+            const char c = fmt[i];
+            const char next = i + 1 < fmt.size() ? fmt[i + 1] : '\0';
+            if ((c == '{' && next == '{') || (c == '}' && next == '}')) {
+                emit(c);
+                ++i;
+            }
+            else if (c == '{' && next == '}') {
+                closeSegment();
+                ++info.placeholders;
+                segStart = info.textLength;
+                ++i;
+            }
+            else if (c == '{' || c == '}') {
+                info.valid = false;
+                return info;
+            }
+            else {
+                emit(c);
+            }
+        }
+        closeSegment();
+        return info;
+    }
+
+    template <std::size_t TextLength, std::size_t Placeholders>
+    struct FormatTable {
+        char text[TextLength + 1]{};
+        FormatSegment segments[Placeholders + 1]{};
+    };
+
+    // S provides `static constexpr std::string_view str()` (generated by the LOGF macros)
+    template <typename S>
+    struct CompiledFormat {
+        static constexpr FormatInfo info = scanFormat(S::str());
+        static constexpr auto table = [] {
+            FormatTable<info.textLength, info.placeholders> t{};
+            scanFormat(S::str(), t.text, t.segments);
+            return t;
+        }();
+    };
+
+    template <typename Compiled, typename... Stored>
+    void formatCompiled([[maybe_unused]] const char* p, std::string& out) {
+        constexpr auto& table = Compiled::table;
+        std::size_t i = 0;
+        auto segment = [&] {
+            const FormatSegment& seg = table.segments[i++];
+            out.append(table.text + seg.offset, seg.length);
+        };
+        ((segment(), decodeArg<Stored>(p, out)), ...);
+        segment();
+    }
+
+    template <typename Compiled, typename... Args>
+    inline constexpr FormatArgsFn compiledArgs = &formatCompiled<Compiled, StoredArg<Args>...>;
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Timestamp cache
+// -----------------------------
+namespace loggy_detail {
+
+    inline std::tm localTime(std::time_t now_c) noexcept {
+        std::tm tm{};
+#if defined(_MSC_VER)
+        if (localtime_s(&tm, &now_c) != 0) {
+            // Error handling: use current time as fallback
+            std::time(&now_c);
+            localtime_s(&tm, &now_c);
+        }
+#else
+        if (localtime_r(&now_c, &tm) == nullptr) {
+            // Error handling: use current time as fallback
+            std::time(&now_c);
+            localtime_r(&now_c, &tm);
+        }
+#endif
+        return tm;
+    }
+
+    // Renders timestamps for a strftime format. The calendar conversion and put_time only run
+    // when the second changes; within a second only the fraction fields are patched into the
+    // cached text. Fraction fields (GNU date style): %N nanoseconds, %3N milliseconds, %6N
+    // microseconds (any width 1-9). Not thread-safe: keep one instance per thread.
+    class TimestampCache {
+    public:
+        std::string_view render(std::chrono::system_clock::time_point tp, std::string_view format) {
+            using namespace std::chrono;
+            const auto second = floor<seconds>(tp);
+            if (format != m_format) compile(format);
+            if (!m_valid || second != m_second) renderSecond(second);
+            if (!m_fractions.empty()) {
+                const auto nanos = static_cast<std::uint64_t>(duration_cast<nanoseconds>(tp - second).count());
+                for (const Fraction& f : m_fractions) writeFraction(&m_text[f.offset], f.digits, nanos);
+            }
+            return m_text;
+        }
+
+    private:
+        struct Piece {
+            std::string strftime;   // empty for a fraction field
+            int digits = 0;         // fraction digits (0 = strftime piece)
+        };
+        struct Fraction {
+            std::size_t offset;
+            int digits;
+        };
+
+        std::string m_format;
+        std::vector<Piece> m_pieces;
+        std::vector<Fraction> m_fractions;
+        std::string m_text;
+        std::chrono::sys_seconds m_second{};
+        bool m_valid = false;
+
+        void compile(std::string_view format) {
+            m_format.assign(format.data(), format.size());
+            m_pieces.clear();
+            m_valid = false;
+            std::string pending;
+            for (std::size_t i = 0; i < format.size(); ++i) {
+                int digits = 0;
+                std::size_t skip = 0;
+                if (format[i] == '%' && i + 1 < format.size()) {
+                    if (format[i + 1] == 'N') { digits = 9; skip = 1; }
+                    else if (format[i + 1] >= '1' && format[i + 1] <= '9' && i + 2 < format.size() && format[i + 2] == 'N') {
+                        digits = format[i + 1] - '0';
+                        skip = 2;
+                    }
+                    else {
+                        pending += format[i];
+                        pending += format[++i]; // keep "%x" (including "%%") intact
+                        continue;
+                    }
+                }
+                if (digits == 0) {
+                    pending += format[i];
+                    continue;
+                }
+                if (!pending.empty()) m_pieces.push_back({ std::move(pending), 0 });
+                pending.clear();
+                m_pieces.push_back({ std::string(), digits });
+                i += skip;
+            }
+            if (!pending.empty()) m_pieces.push_back({ std::move(pending), 0 });
+        }
+
+        void renderSecond(std::chrono::sys_seconds second) {
+            const std::tm tm = localTime(static_cast<std::time_t>(second.time_since_epoch().count()));
+            m_text.clear();
+            m_fractions.clear();
+            for (const Piece& piece : m_pieces) {
+                if (piece.digits) {
+                    m_fractions.push_back({ m_text.size(), piece.digits });
+                    m_text.append(static_cast<std::size_t>(piece.digits), '0');
+                    continue;
+                }
+                char buf[256];
+                const std::size_t n = std::strftime(buf, sizeof(buf), piece.strftime.c_str(), &tm);
+                if (n > 0) {
+                    m_text.append(buf, n);
+                }
+                else {
+                    // Too long for the stack buffer (or legitimately empty)
+                    std::ostringstream oss;
+                    oss << std::put_time(&tm, piece.strftime.c_str());
+                    m_text += oss.str();
+                }
+            }
+            m_second = second;
+            m_valid = true;
+        }
+
+        static void writeFraction(char* dst, int digits, std::uint64_t nanos) noexcept {
+            for (int i = digits; i < 9; ++i) nanos /= 10;
+            for (int i = digits - 1; i >= 0; --i) {
+                dst[i] = static_cast<char>('0' + nanos % 10);
+                nanos /= 10;
+            }
+        }
+    };
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Thread identity
+// -----------------------------
+namespace loggy_detail {
+
+    // Numeric OS thread id (Linux tid, as in `top -H` / perf) with its text pre-rendered.
+    // The text is replaced by the name given to Logger::setThreadName. Records carry a copy,
+    // so a tag stays valid after its thread exited.
+    struct ThreadTag {
+        static constexpr std::size_t kMaxText = 23;
+
+        std::uint64_t id = 0;
+        std::uint8_t length = 0;
+        char text[kMaxText] = {};
+
+        [[nodiscard]] std::string_view view() const noexcept { return { text, length }; }
+
+        void setText(std::string_view value) noexcept {
+            length = static_cast<std::uint8_t>(std::min(value.size(), kMaxText));
+            std::memcpy(text, value.data(), length);
+        }
+
+        void setIdText() noexcept {
+            const auto res = std::to_chars(text, text + kMaxText, id);
+            length = static_cast<std::uint8_t>(res.ptr - text);
+        }
+    };
+
+    inline std::uint64_t osThreadId() noexcept {
+#if defined(_WIN32)
+        return static_cast<std::uint64_t>(GetCurrentThreadId());
+#elif defined(__linux__)
+        return static_cast<std::uint64_t>(::syscall(SYS_gettid));
+#elif defined(__APPLE__)
+        std::uint64_t tid = 0;
+        pthread_threadid_np(nullptr, &tid);
+        return tid;
+#else
+        return static_cast<std::uint64_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+#endif
+    }
+
+    inline ThreadTag& currentThreadTag() noexcept {
+        thread_local ThreadTag tag = [] {
+            ThreadTag t;
+            t.id = osThreadId();
+            t.setIdText();
+            return t;
+        }();
+        return tag;
+    }
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Epoch-based reclamation
+// -----------------------------
+namespace loggy_detail {
+
+    // Read-side sections for objects that are replaced by a pointer swap and freed later
+    // (the Logger's configuration versions). A thread announces the global epoch when it
+    // enters its outermost section and clears the announcement when it leaves. A writer
+    // publishes the replacement, then advances the epoch: an object retired at epoch E can
+    // be freed once no thread announces an epoch below E, because every section that could
+    // have loaded it has ended. One slot per thread, shared by all loggers; slots of exited
+    // threads are reused.
+    class Epochs {
+    public:
+        // Nested sections (a log call from inside a sink) keep the outer announcement
+        static void enter() {
+            Slot& slot = threadSlot();
+            if (slot.depth++ == 0)
+                slot.epoch.store(state().current.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        }
+
+        // Returns whether the outermost section ended
+        static bool leave() noexcept {
+            Slot& slot = threadSlot();
+            if (--slot.depth != 0) return false;
+            slot.epoch.store(0, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] static std::uint64_t current() noexcept {
+            return state().current.load(std::memory_order_seq_cst);
+        }
+
+        // Writer side, after the replacement is published: the epoch the old object retires at
+        static std::uint64_t advance() noexcept {
+            return state().current.fetch_add(1, std::memory_order_seq_cst) + 1;
+        }
+
+        // Lowest epoch announced by a thread inside a section (max if none): objects retired
+        // at or below it are no longer reachable by readers
+        [[nodiscard]] static std::uint64_t oldestActive() noexcept {
+            State& st = state();
+            std::lock_guard<std::mutex> lock(st.mutex);
+            std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+            for (const Slot* slot : st.slots) {
+                const std::uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+                if (epoch != 0) oldest = std::min(oldest, epoch);
+            }
+            return oldest;
+        }
+
+    private:
+        struct alignas(kCacheLine) Slot {
+            std::atomic<std::uint64_t> epoch{ 0 };  // 0: outside any section
+            std::uint32_t depth = 0;                // owner thread only
+            std::atomic<bool> inUse{ false };
+        };
+
+        struct State {
+            std::atomic<std::uint64_t> current{ 1 };
+            std::mutex mutex;                       // guards `slots` (registration and scans)
+            std::vector<Slot*> slots;
+        };
+
+        struct SlotHandle {
+            Slot* slot = acquireSlot();
+            ~SlotHandle() { slot->inUse.store(false, std::memory_order_release); }
+        };
+
+        static State& state() {
+            static State* st = new State();       // never destroyed: threads may log during static destruction
+            return *st;
+        }
+
+        static Slot& threadSlot() {
+            thread_local SlotHandle handle;
+            return *handle.slot;
+        }
+
+        static Slot* acquireSlot() {
+            State& st = state();
+            std::lock_guard<std::mutex> lock(st.mutex);
+            for (Slot* slot : st.slots) {
+                if (!slot->inUse.load(std::memory_order_acquire)) {
+                    slot->inUse.store(true, std::memory_order_relaxed);
+                    return slot;
+                }
+            }
+            st.slots.reserve(st.slots.size() + 1);
+            Slot* slot = new Slot();
+            slot->inUse.store(true, std::memory_order_relaxed);
+            st.slots.push_back(slot);
+            return slot;
+        }
+    };
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Pattern layout
+// -----------------------------
+namespace loggy_detail {
+
+    // Everything a layout can print for one line
+    struct LineFields {
+        LogLevel level = LogLevel::INFO;
+        std::chrono::system_clock::time_point time{};
+        std::uint64_t threadId = 0;
+        std::string_view threadText;    // thread name, or threadId as text
+        const char* file = nullptr;
+        int line = 0;
+        const char* func = nullptr;
+        std::string_view msg;
+    };
+
+    // A line layout compiled once into a flat list of steps that append into one buffer.
+    // Pattern fields:
+    //   %v message   %l level   %t thread id   %s source file   %# line   %! function
+    //   %e / %f / %F  milli- / micro- / nanoseconds   %%  literal '%'
+    // Every other %X is a strftime specifier. Consecutive time specifiers and the literal
+    // text around them form one step rendered through a per-second TimestampCache, so
+    // "%Y-%m-%d %H:%M:%S.%e [" costs one cached copy plus a three-digit patch per line.
+    // Each formatter has its own caches on every thread (found by a small id that is reused
+    // once the formatter is gone), one per time step of its pattern, so neither several
+    // layouts nor several time fields of one pattern evict each other's text.
+    class PatternFormatter {
+    public:
+        explicit PatternFormatter(std::string_view pattern) { compile(pattern); }
+        ~PatternFormatter() { releaseId(m_id); }
+
+        PatternFormatter(const PatternFormatter&) = delete;
+        PatternFormatter& operator=(const PatternFormatter&) = delete;
+
+        // Built-in layout: "time [LEVEL] [T:id] [file:line] func -> msg", where the thread,
+        // source and function parts are left out when disabled or empty.
+        static std::shared_ptr<const PatternFormatter> classic(std::string_view timeFormat) {
+            auto f = std::shared_ptr<PatternFormatter>(new PatternFormatter());
+            f->addTime(timeFormat);
+            f->addLiteral(" [");
+            f->add(Op::Level);
+            f->addLiteral("]");
+            f->add(Op::ThreadTag);
+            f->add(Op::SourceTag);
+            f->add(Op::FunctionTag);
+            f->add(Op::Message);
+            return f;
+        }
+
+        void format(std::string& out, const LineFields& fields, bool includeThreadId) const {
+            thread_local std::vector<std::vector<TimestampCache>> timeCaches;    // [formatter id][time step]
+            std::vector<TimestampCache>* caches = nullptr;
+            if (m_timeSteps != 0) {
+                if (timeCaches.size() <= m_id) timeCaches.resize(std::size_t{ m_id } + 1);
+                caches = &timeCaches[m_id];
+                if (caches->size() < m_timeSteps) caches->resize(m_timeSteps);
+            }
+            for (const Step& step : m_steps) {
+                switch (step.op) {
+                case Op::Literal:
+                    out.append(m_text, step.offset, step.length);
+                    break;
+                case Op::Time:
+                    out += (*caches)[step.cache].render(fields.time, std::string_view(m_text).substr(step.offset, step.length));
+                    break;
+                case Op::Level:
+                    out += loggy_level_name(fields.level);
+                    break;
+                case Op::Thread:
+                    out += fields.threadText;
+                    break;
+                case Op::File:
+                    if (fields.file) out += fields.file;
+                    break;
+                case Op::Line:
+                    appendInt(out, fields.line);
+                    break;
+                case Op::Function:
+                    if (fields.func) out += fields.func;
+                    break;
+                case Op::Message:
+                    out += fields.msg;
+                    break;
+                case Op::ThreadTag:
+                    if (!includeThreadId) break;
+                    out += " [T:";
+                    out += fields.threadText;
+                    out += ']';
+                    break;
+                case Op::SourceTag:
+                    if (!fields.file || !*fields.file) break;
+                    out += " [";
+                    out += fields.file;
+                    out += ':';
+                    appendInt(out, fields.line);
+                    out += ']';
+                    break;
+                case Op::FunctionTag:
+                    out += ' ';
+                    if (fields.func && *fields.func) {
+                        out += fields.func;
+                        out += " -> ";
+                    }
+                    break;
+                }
+            }
+        }
+
+    private:
+        enum class Op : std::uint8_t {
+            Literal, Time, Level, Thread, File, Line, Function, Message,
+            ThreadTag, SourceTag, FunctionTag // conditional parts of the classic layout
+        };
+        struct Step {
+            Op op;
+            std::uint16_t cache = 0;    // Time: which of the formatter's per-thread TimestampCaches renders it
+            std::uint32_t offset = 0;   // Literal text / Time format, as a range of m_text
+            std::uint32_t length = 0;
+        };
+
+        const std::uint32_t m_id = acquireId();
+        std::string m_text;
+        std::vector<Step> m_steps;
+        std::uint16_t m_timeSteps = 0;  // = caches per thread
+
+        PatternFormatter() = default;
+
+        // Ids of live formatters, lowest free first, so the per-thread cache lists stay short
+        struct IdPool {
+            std::mutex mutex;
+            std::vector<std::uint32_t> free;
+            std::uint32_t next = 0;
+        };
+
+        static IdPool& idPool() {
+            static IdPool* pool = new IdPool();   // never destroyed: formatters may outlive statics
+            return *pool;
+        }
+
+        static std::uint32_t acquireId() {
+            IdPool& pool = idPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            if (pool.free.empty()) return pool.next++;
+            const auto lowest = std::min_element(pool.free.begin(), pool.free.end());
+            const std::uint32_t id = *lowest;
+            pool.free.erase(lowest);
+            return id;
+        }
+
+        static void releaseId(std::uint32_t id) noexcept {
+            IdPool& pool = idPool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            try { pool.free.push_back(id); }
+            catch (...) {}   // the id is lost, which only costs cache space
+        }
+
+        void add(Op op) { m_steps.push_back({ op }); }
+
+        void addLiteral(std::string_view text) {
+            if (text.empty()) return;
+            m_steps.push_back({ Op::Literal, 0, static_cast<std::uint32_t>(m_text.size()), static_cast<std::uint32_t>(text.size()) });
+            m_text += text;
+        }
+
+        void addTime(std::string_view format) {
+            // A cache shared by two steps still renders both right, only without the per-second
+            // reuse; that only happens past 65535 time steps
+            if (m_timeSteps < std::numeric_limits<std::uint16_t>::max()) ++m_timeSteps;
+            const auto cache = static_cast<std::uint16_t>(m_timeSteps - 1);
+            m_steps.push_back({ Op::Time, cache, static_cast<std::uint32_t>(m_text.size()), static_cast<std::uint32_t>(format.size()) });
+            m_text += format;
+        }
+
+        void compile(std::string_view pattern) {
+            std::string runFormat;  // strftime format of the current run ('%' escaped)
+            std::string runText;    // the same run as plain text, used if it has no time fields
+            bool runHasTime = false;
+            auto flushRun = [&] {
+                if (runHasTime) addTime(runFormat);
+                else addLiteral(runText);
+                runFormat.clear();
+                runText.clear();
+                runHasTime = false;
+            };
+            for (std::size_t i = 0; i < pattern.size(); ++i) {
+                const char c = pattern[i];
+                if (c != '%' || i + 1 == pattern.size()) {
+                    runText += c;
+                    runFormat += c;
+                    if (c == '%') runFormat += '%';
+                    continue;
+                }
+                const char spec = pattern[++i];
+                Op op = Op::Literal;
+                switch (spec) {
+                case 'v': op = Op::Message; break;
+                case 'l': op = Op::Level; break;
+                case 't': op = Op::Thread; break;
+                case 's': op = Op::File; break;
+                case '#': op = Op::Line; break;
+                case '!': op = Op::Function; break;
+                case '%':
+                    runText += '%';
+                    runFormat += "%%";
+                    continue;
+                case 'e': runFormat += "%3N"; runHasTime = true; continue;
+                case 'f': runFormat += "%6N"; runHasTime = true; continue;
+                case 'F': runFormat += "%N";  runHasTime = true; continue;
+                default:
+                    runFormat += '%';
+                    runFormat += spec;
+                    runHasTime = true;
+                    continue;
+                }
+                flushRun();
+                add(op);
+            }
+            flushRun();
+        }
+
+        static void appendInt(std::string& out, int value) {
+            char tmp[16];
+            const auto res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+            out.append(tmp, res.ptr);
+        }
+    };
+
+} // namespace loggy_detail
+
+// -----------------------------
+// File backends
+// -----------------------------
+namespace loggy_detail {
+
+    // Byte level access to the log file of a LogFileSink; always called under the sink's lock
+    class FileBackend {
+    public:
+        virtual ~FileBackend() = default;
+
+        virtual bool open(const std::filesystem::path& path, bool truncate) = 0;
+        virtual void close() noexcept = 0;
+        [[nodiscard]] virtual bool isOpen() const noexcept = 0;
+        virtual void write(std::string_view data) = 0;
+        virtual void flush() {}
+        virtual void poll(std::chrono::steady_clock::time_point now) { (void)now; }
+
+        // Length of the log data in the file, including what write() accepted but not yet flushed.
+        // Only asked when a file is opened for appending; the sink counts bytes from there.
+        [[nodiscard]] virtual std::uint64_t size() = 0;
+
+        // True when write() is only a memory copy: the sink then skips its batch buffer
+        [[nodiscard]] virtual bool direct() const noexcept { return false; }
+
+        // The sink's rotation size, set before every open (0: no limit)
+        virtual void setSizeLimit(std::uint64_t bytes) noexcept { (void)bytes; }
+
+        // Rotation: true if the renamed file can be replaced by reopen() in place, so there is
+        // no moment without a file; otherwise the sink opens a new backend and closes the old
+        // one in the background
+        [[nodiscard]] virtual bool swapsOnRotate() const noexcept { return false; }
+        virtual bool reopen(const std::filesystem::path& path) {
+            close();
+            return open(path, /*truncate=*/true);
+        }
+
+        std::uint64_t osWrites = 0;  // write calls issued to the OS
+        std::uint64_t lostBytes = 0; // bytes the OS refused (disk full, I/O error, file size limit)
+    };
+
+    // std::ofstream without its own buffer, so each write() is one call to the OS
+    class StreamFileBackend final : public FileBackend {
+    public:
+        bool open(const std::filesystem::path& path, bool truncate) override {
+            std::ios::openmode mode = std::ios::out;
+            if (!truncate) mode |= std::ios::app;
+            m_file.rdbuf()->pubsetbuf(nullptr, 0);
+            m_file.open(path, mode);
+            m_path = path;
+            return m_file.is_open();
+        }
+
+        void close() noexcept override {
+            if (m_file.is_open()) m_file.close();
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept override { return m_file.is_open(); }
+
+        void write(std::string_view data) override {
+            m_file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            ++osWrites;
+        }
+
+        [[nodiscard]] std::uint64_t size() override {
+            std::error_code ec;
+            const auto sz = std::filesystem::file_size(m_path, ec);
+            return ec ? 0 : static_cast<std::uint64_t>(sz);
+        }
+
+    private:
+        std::ofstream m_file;
+        std::filesystem::path m_path;
+    };
+
+#ifndef _WIN32
+    // The file grows in LOGGY_MMAP_CHUNK_SIZE steps (fallocate'd, then mapped); lines are
+    // memcpy'd into the mapping, so logging makes no write() calls. The chunk after the
+    // current one is mapped ahead. Chunks are cut short at the size limit (the rotation size),
+    // so a file ends on a chunk boundary near it. On close the file is truncated to its real
+    // length; until then readers see zero padding after the last line. Appending to a file
+    // that still has the padding (the process died before close) starts after its last line.
+    class MmapFileBackend final : public FileBackend {
+    public:
+        ~MmapFileBackend() override { close(); }
+
+        void setSizeLimit(std::uint64_t bytes) noexcept override {
+            m_limit = bytes ? bytes : std::numeric_limits<std::uint64_t>::max();
+        }
+
+        bool open(const std::filesystem::path& path, bool truncate) override {
+            close();
+            m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+            if (m_fd < 0) return false;
+            struct stat st {};
+            m_size = ::fstat(m_fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+            if (!truncate) m_size = dataEnd(m_fd, m_size);
+            m_synced = m_size;
+            m_current = map(m_size & ~(pageSize() - 1));
+            if (!m_current.data) {
+                close();
+                return false;
+            }
+            m_next = mapAhead();
+            return true;
+        }
+
+        void close() noexcept override {
+            if (m_fd < 0) return;
+            unmap(m_current);
+            unmap(m_next);
+            (void)::ftruncate(m_fd, static_cast<off_t>(m_size));
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept override { return m_fd >= 0; }
+
+        void write(std::string_view data) override {
+            while (!data.empty()) {
+                if (m_size == m_current.end() && !advance()) return;  // out of space: line is lost
+                const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(data.size(), m_current.end() - m_size));
+                std::memcpy(m_current.data + (m_size - m_current.offset), data.data(), n);
+                m_size += n;
+                data.remove_prefix(n);
+            }
+        }
+
+        // Starts write-back of everything written since the last flush (MS_ASYNC: does not wait)
+        void flush() override {
+            if (!m_current.data || m_size <= m_synced) return;
+            const std::uint64_t from = std::max(m_synced, m_current.offset) & ~(pageSize() - 1);
+            ::msync(m_current.data + (from - m_current.offset), static_cast<std::size_t>(m_size - from), MS_ASYNC);
+            m_synced = m_size;
+        }
+
+        [[nodiscard]] std::uint64_t size() override { return m_size; }
+        [[nodiscard]] bool direct() const noexcept override { return true; }
+
+    private:
+        struct Chunk {
+            char* data = nullptr;
+            std::uint64_t offset = 0;
+            std::uint64_t length = 0;
+            [[nodiscard]] std::uint64_t end() const noexcept { return offset + length; }
+        };
+
+        int m_fd = -1;
+        std::uint64_t m_limit = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t m_size = 0;      // bytes of log data
+        std::uint64_t m_synced = 0;    // flushed up to here
+        Chunk m_current;
+        Chunk m_next;
+
+        static std::uint64_t pageSize() noexcept {
+            static const std::uint64_t size = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+            return size;
+        }
+
+        Chunk map(std::uint64_t offset) noexcept {
+            const std::uint64_t page = pageSize();
+            std::uint64_t length = (std::max<std::uint64_t>(LOGGY_MMAP_CHUNK_SIZE, page) + page - 1) & ~(page - 1);
+            if (offset < m_limit && m_limit - offset < length) length = (m_limit - offset + page - 1) & ~(page - 1);
+
+#ifdef __linux__
+            if (::posix_fallocate(m_fd, static_cast<off_t>(offset), static_cast<off_t>(length)) != 0) return {};
+#else
+            if (::ftruncate(m_fd, static_cast<off_t>(offset + length)) != 0) return {};
+#endif
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(length), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                static_cast<off_t>(offset));
+            if (p == MAP_FAILED) return {};
+            return { static_cast<char*>(p), offset, length };
+        }
+
+        // Length without the trailing NUL bytes (log lines contain none)
+        static std::uint64_t dataEnd(int fd, std::uint64_t size) {
+            std::vector<char> block(64 * 1024);
+            while (size > 0) {
+                const std::uint64_t from = size > block.size() ? size - block.size() : 0;
+                const auto length = static_cast<std::size_t>(size - from);
+                if (::pread(fd, block.data(), length, static_cast<off_t>(from)) != static_cast<ssize_t>(length)) return size;
+                std::size_t end = length;
+                while (end > 0 && block[end - 1] == '\0') --end;
+                if (end > 0) return from + end;
+                size = from;
+            }
+            return 0;
+        }
+
+        static void unmap(Chunk& chunk) noexcept {
+            if (chunk.data) ::munmap(chunk.data, static_cast<std::size_t>(chunk.length));
+            chunk = {};
+        }
+
+        // Past the limit the sink rotates instead of writing on, so nothing is mapped ahead there
+        Chunk mapAhead() noexcept {
+            return m_current.end() < m_limit ? map(m_current.end()) : Chunk{};
+        }
+
+        bool advance() noexcept {
+            flush();
+            unmap(m_current);
+            m_current = m_next.data ? m_next : map(m_size);
+            m_next = {};
+            if (!m_current.data) return false;
+            m_next = mapAhead();
+            return true;
+        }
+    };
+#endif
+
+#ifndef _WIN32
+    // Plain descriptor opened O_APPEND | O_CLOEXEC; the sink's batch buffer is the only buffer,
+    // so every batch is one write() and there is no locale or stream state on the way.
+    // Rotation renames the open file and dup3()s a fresh descriptor onto the same number.
+    class PosixFileBackend final : public FileBackend {
+    public:
+        ~PosixFileBackend() override { close(); }
+
+        bool open(const std::filesystem::path& path, bool truncate) override {
+            close();
+            m_fd = openFd(path, truncate);
+            return m_fd >= 0;
+        }
+
+        void close() noexcept override {
+            if (m_fd < 0) return;
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept override { return m_fd >= 0; }
+
+        void write(std::string_view data) override {
+            while (!data.empty()) {
+                const ssize_t n = ::write(m_fd, data.data(), data.size());
+                ++osWrites;
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {       // disk full / I/O error: the rest is lost
+                    lostBytes += data.size();
+                    return;
+                }
+                data.remove_prefix(static_cast<std::size_t>(n));
+            }
+        }
+
+        [[nodiscard]] std::uint64_t size() override {
+            struct stat st {};
+            return ::fstat(m_fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+        }
+
+        [[nodiscard]] bool swapsOnRotate() const noexcept override { return m_fd >= 0; }
+
+        bool reopen(const std::filesystem::path& path) override {
+            const int fd = openFd(path, /*truncate=*/true);
+            if (fd < 0) return false;
+#ifdef __linux__
+            ::dup3(fd, m_fd, O_CLOEXEC);
+#else
+            ::dup2(fd, m_fd);
+            ::fcntl(m_fd, F_SETFD, FD_CLOEXEC);
+#endif
+            ::close(fd);
+            return true;
+        }
+
+    private:
+        int m_fd = -1;
+
+        static int openFd(const std::filesystem::path& path, bool truncate) noexcept {
+            int fd;
+            do {
+                fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+            } while (fd < 0 && errno == EINTR);
+            return fd;
+        }
+    };
+#endif
+
+#if LOGGY_HAS_IO_URING
+    // Writes are copied into a pool of registered buffers and submitted as IORING_OP_WRITE_FIXED
+    // at explicit offsets; the caller only waits when every buffer is in flight. An fdatasync is
+    // queued behind the writes every LOGGY_URING_SYNC_INTERVAL_MS. Uses the raw syscalls (no
+    // liburing). If the kernel refuses io_uring or lacks the write opcodes (before Linux 5.6)
+    // the same buffers are written with pwrite(); so is the rest of a write that fails in the ring.
+    class UringFileBackend final : public FileBackend {
+    public:
+        ~UringFileBackend() override {
+            close();
+            if (m_ring.fd < 0) return;
+            ::munmap(m_ring.sqes, m_ring.sqesSize);
+            if (m_ring.cqMap != m_ring.sqMap) ::munmap(m_ring.cqMap, m_ring.cqMapSize);
+            ::munmap(m_ring.sqMap, m_ring.sqMapSize);
+            ::close(m_ring.fd);    // also unregisters the buffers
+        }
+
+        bool open(const std::filesystem::path& path, bool truncate) override {
+            close();
+            m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+            if (m_fd < 0) return false;
+            struct stat st {};
+            m_offset = ::fstat(m_fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+            m_synced = m_offset;
+            m_lastSync = std::chrono::steady_clock::now();
+            if (m_buffers.empty()) m_buffers.resize(LOGGY_URING_BUFFERS);
+            for (auto& buffer : m_buffers)
+                if (!buffer.data) buffer.data = std::make_unique<char[]>(LOGGY_URING_BUFFER_SIZE);
+            if (m_ring.fd < 0) setupRing();
+            return true;
+        }
+
+        void close() noexcept override {
+            if (m_fd < 0) return;
+            drain();
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        [[nodiscard]] bool isOpen() const noexcept override { return m_fd >= 0; }
+
+        void write(std::string_view data) override {
+            while (!data.empty()) {
+                const std::size_t n = std::min<std::size_t>(data.size(), LOGGY_URING_BUFFER_SIZE);
+                Buffer& buffer = acquire();
+                std::memcpy(buffer.data.get(), data.data(), n);
+                buffer.offset = m_offset;
+                buffer.length = n;
+                buffer.done = 0;
+                m_offset += n;
+                submitWrite(buffer);
+                data.remove_prefix(n);
+            }
+            poll(std::chrono::steady_clock::now());
+        }
+
+        // Waits until the kernel has taken every write (same guarantee as a stream flush)
+        void flush() override { drain(); }
+
+        void poll(std::chrono::steady_clock::time_point now) override {
+            reap();
+            if (LOGGY_URING_SYNC_INTERVAL_MS > 0 && m_offset > m_synced
+                && now - m_lastSync >= std::chrono::milliseconds(LOGGY_URING_SYNC_INTERVAL_MS)) {
+                m_lastSync = now;
+                m_synced = m_offset;
+                submitSync();
+            }
+        }
+
+        [[nodiscard]] std::uint64_t size() override { return m_offset; }
+
+    private:
+        static constexpr std::uint64_t kSyncTag = ~std::uint64_t{ 0 };
+
+        struct Buffer {
+            std::unique_ptr<char[]> data;
+            std::uint64_t offset = 0;
+            std::size_t length = 0;
+            std::size_t done = 0;
+            bool busy = false;
+        };
+
+        // Mapped submission / completion rings of one io_uring instance
+        struct Ring {
+            int fd = -1;
+            void* sqMap = nullptr;
+            void* cqMap = nullptr;
+            std::size_t sqMapSize = 0;
+            std::size_t cqMapSize = 0;
+            io_uring_sqe* sqes = nullptr;
+            std::size_t sqesSize = 0;
+            unsigned* sqTail = nullptr;
+            unsigned* sqMask = nullptr;
+            unsigned* sqArray = nullptr;
+            unsigned* cqHead = nullptr;
+            unsigned* cqTail = nullptr;
+            unsigned* cqMask = nullptr;
+            io_uring_cqe* cqes = nullptr;
+            bool fixedBuffers = false;
+        };
+
+        int m_fd = -1;
+        Ring m_ring;
+        std::vector<Buffer> m_buffers;
+        std::uint64_t m_offset = 0;      // file length once everything submitted has landed
+        std::uint64_t m_synced = 0;
+        std::chrono::steady_clock::time_point m_lastSync{};
+        unsigned m_inFlight = 0;
+
+        void setupRing() noexcept {
+            io_uring_params params{};
+            const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, LOGGY_URING_BUFFERS + 2, &params));
+            if (fd < 0) return;  // ENOSYS / EPERM: stay on pwrite()
+            if (!supportsWrites(fd)) {
+                ::close(fd);
+                return;
+            }
+
+            Ring ring;
+            ring.fd = fd;
+            ring.sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            ring.cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single) ring.sqMapSize = ring.cqMapSize = std::max(ring.sqMapSize, ring.cqMapSize);
+            ring.sqMap = ::mmap(nullptr, ring.sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            ring.cqMap = single ? ring.sqMap
+                : ::mmap(nullptr, ring.cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            void* sqes = ::mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (ring.sqMap == MAP_FAILED || ring.cqMap == MAP_FAILED || sqes == MAP_FAILED) {
+                if (ring.sqMap != MAP_FAILED) ::munmap(ring.sqMap, ring.sqMapSize);
+                if (!single && ring.cqMap != MAP_FAILED) ::munmap(ring.cqMap, ring.cqMapSize);
+                if (sqes != MAP_FAILED) ::munmap(sqes, ring.sqesSize);
+                ::close(fd);
+                return;
+            }
+            auto* sq = static_cast<char*>(ring.sqMap);
+            auto* cq = static_cast<char*>(ring.cqMap);
+            ring.sqes = static_cast<io_uring_sqe*>(sqes);
+            ring.sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            ring.sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            ring.sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            ring.cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            ring.cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            ring.cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            ring.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            // Registered buffers save the kernel a page walk per write; without them (e.g.
+            // RLIMIT_MEMLOCK) plain IORING_OP_WRITE is used
+            std::vector<iovec> iovecs(m_buffers.size());
+            for (std::size_t i = 0; i < m_buffers.size(); ++i)
+                iovecs[i] = { m_buffers[i].data.get(), LOGGY_URING_BUFFER_SIZE };
+            ring.fixedBuffers = ::syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                iovecs.data(), static_cast<unsigned>(iovecs.size())) == 0;
+            m_ring = ring;
+        }
+
+        // Kernels before 5.6 set up a ring but fail every IORING_OP_WRITE (and have no probe)
+        static bool supportsWrites(int fd) noexcept {
+            constexpr unsigned kOps = 64;
+            alignas(io_uring_probe) unsigned char storage[sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op)] = {};
+            auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+            if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, kOps) != 0) return false;
+            auto supported = [&](unsigned op) {
+                return op <= probe->last_op && op < kOps && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            };
+            return supported(IORING_OP_WRITE) && supported(IORING_OP_WRITE_FIXED) && supported(IORING_OP_FSYNC);
+        }
+
+        Buffer& acquire() {
+            for (;;) {
+                for (auto& buffer : m_buffers)
+                    if (!buffer.busy) {
+                        buffer.busy = true;
+                        return buffer;
+                    }
+                waitCompletion();
+            }
+        }
+
+        io_uring_sqe& nextSqe() noexcept {
+            const unsigned tail = *m_ring.sqTail;
+            const unsigned index = tail & *m_ring.sqMask;
+            io_uring_sqe& sqe = m_ring.sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            m_ring.sqArray[index] = index;
+            return sqe;
+        }
+
+        void submit() noexcept {
+            std::atomic_ref<unsigned>(*m_ring.sqTail).fetch_add(1, std::memory_order_release);
+            ++m_inFlight;
+            while (::syscall(__NR_io_uring_enter, m_ring.fd, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR) {}
+            ++osWrites;
+        }
+
+        void submitWrite(Buffer& buffer) {
+            if (m_ring.fd < 0) {
+                writeDirect(buffer);
+                return;
+            }
+            io_uring_sqe& sqe = nextSqe();
+            sqe.opcode = m_ring.fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            sqe.fd = m_fd;
+            sqe.off = buffer.offset + buffer.done;
+            sqe.addr = reinterpret_cast<std::uint64_t>(buffer.data.get() + buffer.done);
+            sqe.len = static_cast<unsigned>(buffer.length - buffer.done);
+            sqe.buf_index = static_cast<std::uint16_t>(&buffer - m_buffers.data());
+            sqe.user_data = static_cast<std::uint64_t>(&buffer - m_buffers.data());
+            submit();
+        }
+
+        void submitSync() noexcept {
+            if (m_ring.fd < 0) {
+                ::fdatasync(m_fd);
+                return;
+            }
+            io_uring_sqe& sqe = nextSqe();
+            sqe.opcode = IORING_OP_FSYNC;
+            sqe.flags = IOSQE_IO_DRAIN;          // after the writes queued before it
+            sqe.fd = m_fd;
+            sqe.fsync_flags = IORING_FSYNC_DATASYNC;
+            sqe.user_data = kSyncTag;
+            submit();
+        }
+
+        void writeDirect(Buffer& buffer) noexcept {
+            while (buffer.done < buffer.length) {
+                const ssize_t n = ::pwrite(m_fd, buffer.data.get() + buffer.done, buffer.length - buffer.done,
+                    static_cast<off_t>(buffer.offset + buffer.done));
+                ++osWrites;
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {       // disk full / I/O error: the rest is lost
+                    lostBytes += buffer.length - buffer.done;
+                    break;
+                }
+                buffer.done += static_cast<std::size_t>(n);
+            }
+            buffer.busy = false;
+        }
+
+        // Handles finished operations; short writes are resubmitted for the remainder, failed
+        // ones are finished with pwrite(), which counts what it cannot write either
+        void reap() {
+            if (m_ring.fd < 0) return;
+            unsigned head = *m_ring.cqHead;
+            const unsigned tail = std::atomic_ref<unsigned>(*m_ring.cqTail).load(std::memory_order_acquire);
+            while (head != tail) {
+                const io_uring_cqe cqe = m_ring.cqes[head & *m_ring.cqMask];
+                ++head;
+                std::atomic_ref<unsigned>(*m_ring.cqHead).store(head, std::memory_order_release);
+                --m_inFlight;
+                if (cqe.user_data == kSyncTag) continue;
+                Buffer& buffer = m_buffers[static_cast<std::size_t>(cqe.user_data)];
+                if (cqe.res <= 0) {
+                    writeDirect(buffer);
+                    continue;
+                }
+                buffer.done += static_cast<std::size_t>(cqe.res);
+                if (buffer.done < buffer.length) submitWrite(buffer);
+                else buffer.busy = false;
+            }
+        }
+
+        void waitCompletion() {
+            reap();
+            if (m_inFlight == 0) return;
+            while (::syscall(__NR_io_uring_enter, m_ring.fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+                && errno == EINTR) {}
+            reap();
+        }
+
+        void drain() noexcept {
+            try {
+                while (m_inFlight > 0) waitCompletion();
+            }
+            catch (...) {}
+        }
+    };
+#endif
+
+    inline std::unique_ptr<FileBackend> makeFileBackend(LogFileBackend kind) {
+#ifndef _WIN32
+        if (kind == LogFileBackend::Mmap) return std::make_unique<MmapFileBackend>();
+        if (kind == LogFileBackend::Posix) return std::make_unique<PosixFileBackend>();
+#endif
+#if LOGGY_HAS_IO_URING
+        if (kind == LogFileBackend::Uring) return std::make_unique<UringFileBackend>();
+#endif
+        (void)kind;
+        return std::make_unique<StreamFileBackend>();
+    }
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Compression of rotated files
+// -----------------------------
+namespace loggy_detail {
+
+    inline constexpr const char* kCompressedExtension = LOGGY_COMPRESS_WITH_ZLIB ? ".gz" : ".lz4";
+    inline constexpr std::size_t kCompressBlock = 64 * 1024;
+
+#if LOGGY_COMPRESS_WITH_ZLIB
+    inline bool compressStream(std::istream& in, std::ostream& out) {
+        z_stream zs{};
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16 /* gzip header */, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+        std::vector<char> input(kCompressBlock), output(kCompressBlock);
+        bool ok = true;
+        int mode = Z_NO_FLUSH;
+        while (ok && mode != Z_FINISH) {
+            in.read(input.data(), static_cast<std::streamsize>(input.size()));
+            const auto n = static_cast<std::size_t>(in.gcount());
+            if (n < input.size()) mode = Z_FINISH;
+            zs.next_in = reinterpret_cast<Bytef*>(input.data());
+            zs.avail_in = static_cast<uInt>(n);
+            do {
+                zs.next_out = reinterpret_cast<Bytef*>(output.data());
+                zs.avail_out = static_cast<uInt>(output.size());
+                if (deflate(&zs, mode) == Z_STREAM_ERROR) ok = false;
+                out.write(output.data(), static_cast<std::streamsize>(output.size() - zs.avail_out));
+            } while (ok && zs.avail_out == 0);
+        }
+        deflateEnd(&zs);
+        return ok && !in.bad() && out.good();
+    }
+#else
+    // One LZ4 block (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md) with greedy
+    // matching through a 4096 entry hash table. `size` is at most kCompressBlock, so every
+    // offset fits 16 bits; `dst` needs lz4Bound(size) bytes. Returns the compressed size.
+    inline constexpr std::size_t lz4Bound(std::size_t size) noexcept { return size + size / 255 + 16; }
+
+    inline std::size_t lz4CompressBlock(const char* src, std::size_t size, char* dst) noexcept {
+        const auto* in = reinterpret_cast<const std::uint8_t*>(src);
+        auto* op = reinterpret_cast<std::uint8_t*>(dst);
+        const auto read32 = [in](std::size_t at) {
+            std::uint32_t v;
+            std::memcpy(&v, in + at, sizeof(v));
+            return v;
+        };
+        const auto putLength = [&op](std::size_t length) {
+            for (; length >= 255; length -= 255) *op++ = 255;
+            *op++ = static_cast<std::uint8_t>(length);
+        };
+        // Literals since `anchor`, then (unless matchLength is 0: the last sequence) a match
+        const auto sequence = [&](std::size_t anchor, std::size_t literals, std::size_t offset, std::size_t matchLength) {
+            std::uint8_t* token = op++;
+            *token = static_cast<std::uint8_t>(std::min<std::size_t>(literals, 15) << 4);
+            if (literals >= 15) putLength(literals - 15);
+            std::memcpy(op, in + anchor, literals);
+            op += literals;
+            if (matchLength == 0) return;
+            *op++ = static_cast<std::uint8_t>(offset);
+            *op++ = static_cast<std::uint8_t>(offset >> 8);
+            const std::size_t extra = matchLength - 4;
+            *token |= static_cast<std::uint8_t>(std::min<std::size_t>(extra, 15));
+            if (extra >= 15) putLength(extra - 15);
+        };
+
+        std::size_t anchor = 0;
+        if (size > 12) {
+            const std::size_t matchEnd = size - 5;      // the last 5 bytes are always literals
+            const std::size_t lastStart = size - 12;    // and no match starts in the last 12
+            std::uint32_t table[4096] = {};
+            std::size_t pos = 0;
+            while (pos < lastStart) {
+                const std::uint32_t seq = read32(pos);
+                const std::uint32_t hash = (seq * 2654435761u) >> 20;
+                std::size_t ref = table[hash];
+                table[hash] = static_cast<std::uint32_t>(pos);
+                if (ref >= pos || read32(ref) != seq) {
+                    ++pos;
+                    continue;
+                }
+                std::size_t start = pos;
+                while (start > anchor && ref > 0 && in[start - 1] == in[ref - 1]) {
+                    --start;
+                    --ref;
+                }
+                std::size_t length = 4 + (pos - start);
+                while (start + length < matchEnd && in[start + length] == in[ref + length]) ++length;
+                sequence(anchor, start - anchor, start - ref, length);
+                pos = anchor = start + length;
+            }
+        }
+        sequence(anchor, size - anchor, 0, 0);
+        return static_cast<std::size_t>(op - reinterpret_cast<std::uint8_t*>(dst));
+    }
+
+    // LZ4 frame (readable by `lz4 -d`): independent 64 KB blocks, no checksums
+    inline bool compressStream(std::istream& in, std::ostream& out) {
+        const auto put32 = [&out](std::uint32_t v) {
+            const char bytes[4] = { static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16), static_cast<char>(v >> 24) };
+            out.write(bytes, 4);
+        };
+        put32(0x184D2204);                      // magic
+        const char descriptor[3] = { 0x60, 0x40, static_cast<char>(0x82) };  // FLG, BD (64 KB), header checksum
+        out.write(descriptor, 3);
+
+        std::vector<char> input(kCompressBlock), output(lz4Bound(kCompressBlock));
+        for (;;) {
+            in.read(input.data(), static_cast<std::streamsize>(input.size()));
+            const auto n = static_cast<std::size_t>(in.gcount());
+            if (n == 0) break;
+            const std::size_t packed = lz4CompressBlock(input.data(), n, output.data());
+            if (packed < n) {
+                put32(static_cast<std::uint32_t>(packed));
+                out.write(output.data(), static_cast<std::streamsize>(packed));
+            }
+            else {
+                put32(static_cast<std::uint32_t>(n) | 0x80000000u);   // stored uncompressed
+                out.write(input.data(), static_cast<std::streamsize>(n));
+            }
+        }
+        put32(0);                               // end mark
+        return !in.bad() && out.good();
+    }
+#endif
+
+    // Replaces `from` by its compressed copy `to`. On failure `from` stays and `to` is not created.
+    inline bool compressFile(const std::filesystem::path& from, const std::filesystem::path& to) {
+        auto partial = to;
+        partial += ".tmp";
+        std::error_code ec;
+        bool ok = false;
+        {
+            std::ifstream in(from, std::ios::binary);
+            std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+            if (in && out) ok = compressStream(in, out);
+            out.close();
+            ok = ok && !out.fail();
+        }
+        if (ok) {
+            // Keeps the time of the last log line, which retention by age goes by
+            const auto written = std::filesystem::last_write_time(from, ec);
+            if (!ec) std::filesystem::last_write_time(partial, written, ec);
+            std::filesystem::rename(partial, to, ec);
+        }
+        if (!ok || ec) {
+            std::filesystem::remove(partial, ec);
+            return false;
+        }
+        std::filesystem::remove(from, ec);
+        return true;
+    }
+
+    // Housekeeping must not compete with the threads that log
+    inline void lowerThreadPriority() noexcept {
+#if defined(_WIN32)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+        ::setpriority(PRIO_PROCESS, static_cast<id_t>(osThreadId()), 10);   // per thread on Linux
+#endif
+    }
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Background maintenance
+// -----------------------------
+namespace loggy_detail {
+
+    // Worker thread for file housekeeping that must not run on the logging path (renaming
+    // rotated files, closing retired backends, compression). Started by the first post() or
+    // arm() and runs at low priority; jobs run one at a time in posting order, and exceptions
+    // from a job are ignored. Besides jobs it runs one timed callback (setTick / arm).
+    class MaintenanceThread {
+    public:
+        MaintenanceThread() = default;
+        MaintenanceThread(const MaintenanceThread&) = delete;
+        MaintenanceThread& operator=(const MaintenanceThread&) = delete;
+        ~MaintenanceThread() { stop(); }
+
+        void post(std::function<void()> job) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+            if (!m_thread.joinable()) m_thread = std::thread(&MaintenanceThread::run, this);
+            m_cv.notify_one();
+        }
+
+        // The callback run at the time given to arm(); set once, before the first arm()
+        void setTick(std::function<void()> tick) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tick = std::move(tick);
+        }
+
+        // Runs the tick at `deadline`, or at the earlier deadline it is armed for already.
+        // Allocates nothing once the thread is running, so it may be called per batch.
+        void arm(std::chrono::steady_clock::time_point deadline) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_armed && m_deadline <= deadline) return;
+            m_armed = true;
+            m_deadline = deadline;
+            if (!m_thread.joinable()) m_thread = std::thread(&MaintenanceThread::run, this);
+            m_cv.notify_one();
+        }
+
+        // Blocks until every job posted so far has run
+        void wait() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_idleCv.wait(lock, [&] { return m_jobs.empty() && !m_busy; });
+        }
+
+        // Runs the remaining jobs, then joins the thread (a pending tick is dropped)
+        void stop() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_thread.joinable()) return;
+                m_stop = true;
+                m_cv.notify_one();
+            }
+            m_thread.join();
+            m_thread = std::thread();
+            m_stop = false;
+            m_armed = false;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::condition_variable m_idleCv;
+        std::deque<std::function<void()>> m_jobs;
+        std::function<void()> m_tick;
+        std::chrono::steady_clock::time_point m_deadline{};
+        bool m_armed = false;
+        bool m_busy = false;
+        bool m_stop = false;
+        std::thread m_thread;
+
+        void run() {
+            lowerThreadPriority();
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;) {
+                if (m_jobs.empty() && !m_stop) {
+                    if (m_armed) m_cv.wait_until(lock, m_deadline);
+                    else m_cv.wait(lock);
+                }
+                std::function<void()> job;
+                if (m_armed && std::chrono::steady_clock::now() >= m_deadline) m_armed = false;
+                else if (!m_jobs.empty()) {
+                    job = std::move(m_jobs.front());
+                    m_jobs.pop_front();
+                }
+                else if (m_stop) break;         // stop requested and nothing left
+                else continue;
+                m_busy = true;
+                lock.unlock();
+                try {
+                    if (job) job();
+                    else if (m_tick) m_tick();
+                }
+                catch (...) {}
+                job = nullptr;
+                lock.lock();
+                m_busy = false;
+                if (m_jobs.empty()) m_idleCv.notify_all();
+            }
+        }
+    };
+
+} // namespace loggy_detail
+
+// -----------------------------
+// Sinks
+// -----------------------------
+
+// One log call in structured form, as handed to structured sinks (LogSink::structured).
+// The views and pointers are only valid during the call.
+struct LogRecord {
+    std::chrono::system_clock::time_point time{};
+    LogLevel level = LogLevel::INFO;
+    std::uint64_t threadId = 0;     // OS thread id, also when the thread has a name
+    std::string_view threadName;    // Logger::setThreadName, or threadId as text
+    const char* file = nullptr;     // nullptr unless logged with LOG_EX / LOGF_EX / source_location
+    int line = 0;
+    const char* function = nullptr;
+    std::string_view message;       // the formatted message, without layout
+};
+
+// Output target for formatted lines. A Logger owns a list of sinks (Logger::addSink), each
+// with its own minimum level and layout. In synchronous mode write() may be called from
+// several threads at once, in async mode only from the backend thread.
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    virtual void write(LogLevel level, std::string_view line) = 0;
+
+    // A structured sink gets writeRecord() instead of write() and never costs a layout.
+    // Queried once when the sink is added.
+    [[nodiscard]] virtual bool structured() const noexcept { return false; }
+    virtual void writeRecord(const LogRecord& record) { (void)record; }
+
+    // A text sink that also wants the fields of each line gets writeLine() instead of
+    // write() (and instead of tryWrite()). Queried once when the sink is added.
+    [[nodiscard]] virtual bool wantsFields() const noexcept { return false; }
+    virtual void writeLine(const LogRecord& record, std::string_view line) { write(record.level, line); }
+
+    // False while the sink would discard every line anyway (e.g. a file sink without an
+    // open file); the logger then does not format lines for it.
+    [[nodiscard]] virtual bool ready() const noexcept { return true; }
+
+    // Used with LOGGY_BEST_EFFORT_TRYLOCK; returns false if the line was skipped instead of waiting
+    virtual bool tryWrite(LogLevel level, std::string_view line) {
+        write(level, line);
+        return true;
+    }
+
+    virtual void flush() {}
+
+    // Called by the async backend after every pass over the queues and at least every
+    // LOGGY_ASYNC_IDLE_SLEEP_US, for time based work such as latency bounded batches
+    virtual void poll(std::chrono::steady_clock::time_point now) { (void)now; }
+};
+
+// std::cout, colored per level on Windows (LOGGY_COLORIZE_CONSOLE)
+class LogConsoleSink : public LogSink {
+public:
+    void write(LogLevel level, std::string_view line) override {
+#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
+        setConsoleColor(level);
+        std::cout << line << '\n';
+        resetConsoleColor();
+#else
+        (void)level;
+        std::cout << line << '\n';
+#endif
+    }
+
+    void flush() override { std::cout.flush(); }
+
+private:
+    static void setConsoleColor(LogLevel level) {
+#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
+        HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+        WORD color = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+        switch (level) {
+        case LogLevel::DEBUG: color = FOREGROUND_BLUE | FOREGROUND_GREEN; break;           // cyan
+        case LogLevel::INFO:  color = FOREGROUND_GREEN; break;
+        case LogLevel::WARN:  color = FOREGROUND_RED | FOREGROUND_GREEN; break;            // yellow
+        case LogLevel::ERR:   color = FOREGROUND_RED; break;
+        case LogLevel::FATAL: color = FOREGROUND_RED | FOREGROUND_INTENSITY; break;
+        default: break;
+        }
+        SetConsoleTextAttribute(h, color);
+#else
+        (void)level;
+#endif
+    }
+
+    static void resetConsoleColor() {
+#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
+        HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleTextAttribute(h, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+#endif
+    }
+};
+
+#ifndef _WIN32
+// Console sink that bypasses iostreams: lines go to fd 1 (DEBUG..WARN) or fd 2 (ERR, FATAL)
+// with one write() each, prefixed with pre-rendered ANSI colors when the fd is a terminal
+// (LOGGY_COLORIZE_CONSOLE). Like stdio, output to a terminal is written per line while a pipe
+// or file is buffered (LOGGY_CONSOLE_BUFFER_SIZE) until full, flush() or the backend's poll().
+class LogAnsiConsoleSink : public LogSink {
+public:
+    explicit LogAnsiConsoleSink(bool colors = LOGGY_COLORIZE_CONSOLE != 0) {
+        for (Output* out : { &m_stdout, &m_stderr }) {
+            out->terminal = ::isatty(out->fd) == 1;
+            out->colors = colors && out->terminal;
+            out->buffer.reserve(LOGGY_CONSOLE_BUFFER_SIZE + 1024);
+        }
+    }
+
+    ~LogAnsiConsoleSink() override {
+        try { flush(); }
+        catch (...) {}
+    }
+
+    void write(LogLevel level, std::string_view line) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const bool error = level >= LogLevel::ERR;
+        Output& out = error ? m_stderr : m_stdout;
+        if (error) writeOut(m_stdout);  // keep buffered stdout lines ahead of the error
+        if (out.colors) out.buffer.append(colorPrefix(level));
+        out.buffer.append(line);
+        if (out.colors) out.buffer.append(kReset);
+        out.buffer.push_back('\n');
+        if (out.terminal || error || out.buffer.size() >= LOGGY_CONSOLE_BUFFER_SIZE) writeOut(out);
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeOut(m_stdout);
+        writeOut(m_stderr);
+    }
+
+    void poll(std::chrono::steady_clock::time_point) override {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        writeOut(m_stdout);
+        writeOut(m_stderr);
+    }
+
+private:
+    static constexpr std::string_view kReset = "\x1b[0m";
+
+    struct Output {
+        explicit Output(int descriptor) : fd(descriptor) {}
+        int fd;
+        bool terminal = false;
+        bool colors = false;
+        std::string buffer;
+    };
+
+    std::mutex m_mutex;
+    Output m_stdout{ STDOUT_FILENO };
+    Output m_stderr{ STDERR_FILENO };
+
+    // Same scheme as the Windows console colors of LogConsoleSink
+    static constexpr std::string_view colorPrefix(LogLevel level) noexcept {
+        switch (level) {
+        case LogLevel::DEBUG: return "\x1b[36m";    // cyan
+        case LogLevel::INFO:  return "\x1b[32m";    // green
+        case LogLevel::WARN:  return "\x1b[33m";    // yellow
+        case LogLevel::ERR:   return "\x1b[31m";    // red
+        case LogLevel::FATAL: return "\x1b[1;31m";  // bright red
+        default:              return "";
+        }
+    }
+
+    static void writeOut(Output& out) noexcept {
+        std::string_view data = out.buffer;
+        while (!data.empty()) {
+            const ssize_t n = ::write(out.fd, data.data(), data.size());
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;  // closed / broken pipe: drop
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+        out.buffer.clear();
+    }
+};
+#endif
+
+// Keeps the last `capacity` lines in memory, e.g. for an admin endpoint or a crash report.
+// All storage is allocated up front (capacity x maxLineBytes); lines longer than that are cut.
+// write() holds the lock for one copy; snapshot() holds it for a single memcpy of the ring
+// and builds the strings afterwards.
+class LogRingSink : public LogSink {
+public:
+    explicit LogRingSink(std::size_t capacity, std::size_t maxLineBytes = LOGGY_RING_LINE_SIZE)
+        : m_capacity(std::max<std::size_t>(capacity, 1)), m_lineSize(maxLineBytes),
+          m_storage(m_capacity * m_lineSize), m_lengths(m_capacity) {
+    }
+
+    void write(LogLevel, std::string_view line) override {
+        const std::size_t length = std::min(line.size(), m_lineSize);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::size_t slot = static_cast<std::size_t>(m_written % m_capacity);
+        std::memcpy(m_storage.data() + slot * m_lineSize, line.data(), length);
+        m_lengths[slot] = static_cast<std::uint32_t>(length);
+        ++m_written;
+    }
+
+    // The stored lines, oldest first
+    [[nodiscard]] std::vector<std::string> snapshot() const {
+        std::vector<char> storage(m_storage.size());
+        std::vector<std::uint32_t> lengths(m_capacity);
+        std::uint64_t written = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            written = m_written;
+            const std::size_t used = static_cast<std::size_t>(std::min<std::uint64_t>(written, m_capacity));
+            std::memcpy(storage.data(), m_storage.data(), used * m_lineSize);
+            std::memcpy(lengths.data(), m_lengths.data(), used * sizeof(std::uint32_t));
+        }
+
+        const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(written, m_capacity));
+        std::vector<std::string> lines;
+        lines.reserve(count);
+        for (std::uint64_t i = written - count; i < written; ++i) {
+            const std::size_t slot = static_cast<std::size_t>(i % m_capacity);
+            lines.emplace_back(storage.data() + slot * m_lineSize, lengths[slot]);
+        }
+        return lines;
+    }
+
+    // Lines written since construction / clear(), including those already overwritten
+    [[nodiscard]] std::uint64_t written() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written = 0;
+    }
+
+private:
+    const std::size_t m_capacity;
+    const std::size_t m_lineSize;
+    mutable std::mutex m_mutex;
+    std::vector<char> m_storage;            // m_capacity slots of m_lineSize bytes
+    std::vector<std::uint32_t> m_lengths;
+    std::uint64_t m_written = 0;
+};
+
+#ifndef _WIN32
+// Counters of a LogSocketSink
+struct LogSocketStats {
+    std::uint64_t sent = 0;         // lines handed to the socket
+    std::uint64_t dropped = 0;      // lines lost: buffer full, too long for a datagram, or unsent at close()
+    std::uint64_t sendCalls = 0;
+    std::uint64_t reconnects = 0;
+};
+
+// Sends lines to a local collector on a Unix domain socket. Lines are queued in one buffer
+// and sent in batches: sendmmsg() with one datagram per line (LogSocketMode::Datagram), or
+// one send() of newline framed lines (LogSocketMode::Stream). A batch goes out when the
+// buffer is half full, its oldest line is LOGGY_SOCKET_BATCH_LATENCY_US old, on flush() or
+// poll(). The socket is non-blocking: a slow or absent collector never stalls the caller,
+// lines wait up to LOGGY_SOCKET_BUFFER_SIZE bytes and are then dropped (counted). A lost
+// connection is retried with exponential backoff (100 ms .. 5 s).
+class LogSocketSink : public LogSink {
+public:
+    explicit LogSocketSink(std::string path, LogSocketMode mode = LogSocketMode::Datagram)
+        : m_path(std::move(path)), m_mode(mode) {
+        m_pending.reserve(LOGGY_SOCKET_BUFFER_SIZE);
+    }
+
+    ~LogSocketSink() override { close(); }
+
+    // Sends what the socket takes right now, counts the rest as dropped and disconnects.
+    // Later writes reconnect.
+    void close() noexcept {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sendPending(std::chrono::steady_clock::now());
+        m_stats.dropped += m_ends.size();
+        m_pending.clear();
+        m_ends.clear();
+        m_partial = 0;
+        m_stalled = false;
+        disconnect();
+    }
+
+    void write(LogLevel, std::string_view line) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        if (m_pending.size() + line.size() + 1 > LOGGY_SOCKET_BUFFER_SIZE) {
+            if (now - m_batchStart >= kBatchLatency) sendPending(now);
+            if (m_pending.size() + line.size() + 1 > LOGGY_SOCKET_BUFFER_SIZE) {
+                ++m_stats.dropped;
+                return;
+            }
+        }
+        if (m_ends.empty()) m_batchStart = now;
+        m_pending.append(line);
+        m_pending.push_back('\n');
+        m_ends.push_back(m_pending.size());
+        if ((!m_stalled && m_pending.size() >= LOGGY_SOCKET_BUFFER_SIZE / 2) || now - m_batchStart >= kBatchLatency) {
+            sendPending(now);
+        }
+    }
+
+    // Sends what the socket takes right now; never waits for the collector
+    void flush() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sendPending(std::chrono::steady_clock::now());
+    }
+
+    void poll(std::chrono::steady_clock::time_point now) override {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock() && !m_ends.empty()) sendPending(now);
+    }
+
+    [[nodiscard]] LogSocketStats stats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    [[nodiscard]] bool connected() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_fd >= 0;
+    }
+
+private:
+    static constexpr auto kBatchLatency = std::chrono::microseconds(LOGGY_SOCKET_BATCH_LATENCY_US);
+    static constexpr auto kMinBackoff = std::chrono::milliseconds(100);
+    static constexpr auto kMaxBackoff = std::chrono::milliseconds(5000);
+    static constexpr std::size_t kMaxDatagrams = 64;    // per sendmmsg call
+
+    const std::string m_path;
+    const LogSocketMode m_mode;
+    std::mutex m_mutex;
+    int m_fd = -1;
+    std::string m_pending;                  // lines, each followed by '\n'
+    std::vector<std::size_t> m_ends;        // end offset (after '\n') of every pending line
+    std::size_t m_partial = 0;              // stream mode: bytes of the first line already sent
+    bool m_stalled = false;                 // last send left lines behind (collector busy or away)
+    std::chrono::steady_clock::time_point m_batchStart{};
+    std::chrono::steady_clock::time_point m_nextConnect{};
+    std::chrono::milliseconds m_backoff = kMinBackoff;
+    LogSocketStats m_stats;
+
+    bool ensureConnected(std::chrono::steady_clock::time_point now) noexcept {
+        if (m_fd >= 0) return true;
+        if (now < m_nextConnect) return false;
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (m_path.size() >= sizeof(addr.sun_path)) return false;
+        std::memcpy(addr.sun_path, m_path.c_str(), m_path.size() + 1);
+
+        const int type = m_mode == LogSocketMode::Datagram ? SOCK_DGRAM : SOCK_STREAM;
+#ifdef __linux__
+        int fd = ::socket(AF_UNIX, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+        int fd = ::socket(AF_UNIX, type, 0);
+        if (fd >= 0) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+        // A non-blocking connect that does not finish at once (full backlog) counts as failed
+        if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            if (fd >= 0) ::close(fd);
+            m_nextConnect = now + m_backoff;
+            m_backoff = std::min(m_backoff * 2, kMaxBackoff);
+            return false;
+        }
+        m_fd = fd;
+        m_backoff = kMinBackoff;
+        ++m_stats.reconnects;
+        return true;
+    }
+
+    void disconnect() noexcept {
+        if (m_fd < 0) return;
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    void sendPending(std::chrono::steady_clock::time_point now) noexcept {
+        std::size_t lines = 0;
+        std::size_t bytes = 0;
+        std::size_t skipped = 0;    // of `lines`, the ones the socket refused for good
+        while (lines < m_ends.size() && ensureConnected(now)) {
+            const std::size_t sent = m_mode == LogSocketMode::Datagram
+                ? sendDatagrams(lines, bytes, skipped)
+                : sendStream(lines, bytes);
+            if (sent == 0) break;
+        }
+        // What the socket did not take waits for the next batch instead of being retried per line
+        m_batchStart = now;
+        m_stalled = lines < m_ends.size();
+        if (lines == 0) return;
+        m_stats.sent += lines - skipped;
+        m_stats.dropped += skipped;
+        m_pending.erase(0, bytes);
+        m_ends.erase(m_ends.begin(), m_ends.begin() + static_cast<std::ptrdiff_t>(lines));
+        for (auto& end : m_ends) end -= bytes;
+    }
+
+    // One sendmmsg() for up to kMaxDatagrams lines starting at line `first`; returns lines
+    // done with, including one that is too long for a datagram (added to `skipped`)
+    std::size_t sendDatagrams(std::size_t& first, std::size_t& bytes, std::size_t& skipped) noexcept {
+        iovec iov[kMaxDatagrams];
+        const std::size_t count = std::min(kMaxDatagrams, m_ends.size() - first);
+        std::size_t begin = bytes;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t end = m_ends[first + i];
+            iov[i] = { m_pending.data() + begin, end - begin - 1 };  // without the '\n'
+            begin = end;
+        }
+        int sent = 0;
+#ifdef __linux__
+        mmsghdr msgs[kMaxDatagrams];
+        for (std::size_t i = 0; i < count; ++i) {
+            msgs[i] = {};
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        do {
+            sent = ::sendmmsg(m_fd, msgs, static_cast<unsigned>(count), MSG_DONTWAIT);
+        } while (sent < 0 && errno == EINTR);
+        ++m_stats.sendCalls;
+#else
+        for (; static_cast<std::size_t>(sent) < count; ++sent) {
+            ++m_stats.sendCalls;
+            if (::send(m_fd, iov[sent].iov_base, iov[sent].iov_len, MSG_DONTWAIT) < 0) break;
+        }
+        if (sent == 0) sent = -1;
+#endif
+        if (sent <= 0) {
+            if (errno == EMSGSIZE) {            // first line can never be delivered: skip it
+                sent = 1;
+                ++skipped;
+            }
+            else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS) handleError();
+                return 0;
+            }
+        }
+        first += static_cast<std::size_t>(sent);
+        bytes = m_ends[first - 1];
+        return static_cast<std::size_t>(sent);
+    }
+
+    // One send() of every pending line; returns complete lines sent
+    std::size_t sendStream(std::size_t& first, std::size_t& bytes) noexcept {
+        const std::size_t from = bytes + m_partial;
+        ssize_t n;
+        do {
+            n = ::send(m_fd, m_pending.data() + from, m_pending.size() - from, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (n < 0 && errno == EINTR);
+        ++m_stats.sendCalls;
+        if (n <= 0) {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) handleError();
+            return 0;
+        }
+        const std::size_t upTo = from + static_cast<std::size_t>(n);
+        const std::size_t before = first;
+        while (first < m_ends.size() && m_ends[first] <= upTo) ++first;
+        bytes = first > 0 ? m_ends[first - 1] : 0;
+        m_partial = upTo - bytes;
+        return first - before;
+    }
+
+    // Collector gone: reconnect later
+    void handleError() noexcept {
+        disconnect();
+        m_partial = 0;              // a new stream starts with a whole line (the cut one is resent)
+        m_nextConnect = std::chrono::steady_clock::now() + m_backoff;
+    }
+};
 #endif
 
-#ifdef _WIN32
-    #include <windows.h>
-    #include <cstdio>
-#endif
+// Write statistics of a LogFileSink
+struct LogFileStats {
+    std::uint64_t lines = 0;
+    std::uint64_t writes = 0;    // write calls issued to the OS (0 with LogFileBackend::Mmap)
+    std::uint64_t bytes = 0;
+    std::uint64_t lostBytes = 0; // of `bytes`, refused by the OS (Posix and Uring backends)
+
+    [[nodiscard]] double syscallsPerLine() const noexcept {
+        return lines ? static_cast<double>(writes) / static_cast<double>(lines) : 0.0;
+    }
+};
+
+// Size rotation and retention of a LogFileSink, changeable at run time (setRotationPolicy).
+// The macros only give the defaults.
+struct LogRotationPolicy {
+    std::uint64_t maxFileSize = LOGGY_MAX_LOG_FILE_SIZE;  // rotate before a file would grow past this (0: never)
+    int maxBackups = LOGGY_ROTATE_BACKUPS;                // numbered backups per file name (0: the file is truncated instead)
+    std::uint64_t maxTotalBytes = 0;                      // all rotated files together (0: no limit)
+    std::chrono::seconds maxAge{ 0 };                     // rotated files last written longer ago are deleted (0: no limit)
+};
+
+// Log file with size based rotation (LogRotationPolicy, defaults from LOGGY_MAX_LOG_FILE_SIZE
+// and LOGGY_ROTATE_BACKUPS).
+// Lines are gathered in one buffer and written with a single call once LOGGY_FILE_BATCH_BYTES
+// (setBufferSize) are pending, the oldest pending line is LOGGY_FILE_BATCH_LATENCY_US old, or on flush().
+// The age is checked on every write, from poll() in async mode and by a timer on the
+// maintenance thread, so the last lines before a pause reach the file in sync mode too.
+// With LogFileBackend::Mmap lines are copied straight into the mapped file instead.
+// The sink counts the bytes of the current file (seeded from its size when appending), so it
+// rotates right before the line that would cross the size limit without asking the file system.
+class LogFileSink : public LogSink {
+public:
+    explicit LogFileSink(LogFileBackend backend = LogFileBackend::Stream)
+        : m_backendKind(backend), m_file(loggy_detail::makeFileBackend(backend)) {
+        m_maintenance.setTick([this] { writeDueBatch(); });
+    }
+
+    explicit LogFileSink(const std::filesystem::path& path, LogFileBackend backend = LogFileBackend::Stream)
+        : LogFileSink(backend) {
+        open(path);
+    }
+
+    ~LogFileSink() override { close(); }
+
+    // Creates the directory and opens (truncates) the file
+    void open(const std::filesystem::path& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        closeFile();
+        m_pathPattern = path;
+        openCurrentFile();
+        m_open.store(m_file->isOpen(), std::memory_order_relaxed);
+        if (m_file->isOpen()) postRetention();  // files left over from earlier runs
+    }
+
+    // Takes effect with the next line. Retention limits (maxTotalBytes, maxAge) are applied in
+    // the background after every rotation, on open() and here: rotated files of this sink are
+    // deleted oldest first (by last write time) until they fit. They are found by name in the
+    // directory of the current file: numbered backups and, with time rotation, files of past
+    // periods. A lower maxBackups drops the extra numbered backups at the next rotation.
+    void setRotationPolicy(const LogRotationPolicy& policy) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_policy = policy;
+        m_policy.maxBackups = std::max(policy.maxBackups, 0);
+        m_file->setSizeLimit(m_policy.maxFileSize);
+        if (m_file->isOpen()) postRetention();
+    }
+
+    [[nodiscard]] LogRotationPolicy rotationPolicy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_policy;
+    }
+
+    // Starts a new file every hour / day. The path given to open() is then a strftime pattern
+    // for the file names, e.g. "logs/app-%Y%m%d-%H.log", rendered with the local start time of
+    // each period; a file of the current period that already exists is appended to. The size
+    // limit still applies within a period (app-20240101-13.log.1, ...). An open file moves to
+    // the current period's name at once.
+    void setTimeRotation(LogRotateInterval interval) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (interval == m_interval && m_period.count() == 0) return;
+        m_interval = interval;
+        m_period = std::chrono::seconds(0);
+        reopenForPeriod();
+    }
+
+    // Starts a new file at every multiple of `period` since the epoch (e.g. 15 minutes: at
+    // :00, :15, :30, :45 in time zones with whole-hour offsets). A zero period switches time
+    // rotation off.
+    void setTimeRotation(std::chrono::seconds period) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        period = std::max(period, std::chrono::seconds(0));
+        if (period == m_period && m_interval == LogRotateInterval::Never) return;
+        m_interval = LogRotateInterval::Never;
+        m_period = period;
+        reopenForPeriod();
+    }
+
+    // Compresses every file that leaves the active position (size backups and past periods)
+    // on the maintenance thread: gzip with LOGGY_COMPRESS_WITH_ZLIB, otherwise LZ4 frames.
+    // Compressed backups keep their place in the chain (app.log.1.lz4, app.log.2.lz4, ...).
+    void setCompression(bool enable) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_compress = enable;
+    }
+
+    // Switches the way bytes reach the file; an open file is continued (appended to)
+    void setBackend(LogFileBackend backend) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (backend == m_backendKind) return;
+        const bool wasOpen = m_file->isOpen();
+        closeFile();
+        m_stats.writes += m_file->osWrites;
+        m_stats.lostBytes += m_file->lostBytes;
+        m_backendKind = backend;
+        m_file = loggy_detail::makeFileBackend(backend);
+        m_spare.reset();
+        if (wasOpen) openLogFile(/*truncate=*/false);
+    }
+
+    // Also waits for rotations still being finished in the background
+    void close() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open.store(false, std::memory_order_relaxed);
+            closeFile();
+        }
+        try { m_maintenance.wait(); }
+        catch (...) {}
+    }
+
+    // Size of the batch buffer, i.e. bytes per write call under load (0: every line is written)
+    void setBufferSize(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeBatch();
+        m_batchLimit = bytes;
+        m_batch.shrink_to_fit();
+        m_batch.reserve(bytes + 1024);
+    }
+
+    void write(LogLevel, std::string_view line) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeLocked(line);
+    }
+
+    bool tryWrite(LogLevel, std::string_view line) override {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) return false;
+        writeLocked(line);
+        return true;
+    }
+
+    void flush() override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writeBatch();
+        m_file->flush();
+    }
+
+    void poll(std::chrono::steady_clock::time_point now) override {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);  // busy: a writer is on it
+        if (!lock.owns_lock()) return;
+        if (!m_batch.empty() && now - m_batchStart >= kBatchLatency) writeBatch();
+        if (m_file->isOpen()) m_file->poll(now);
+    }
+
+    [[nodiscard]] bool ready() const noexcept override { return m_open.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] LogFileStats stats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        LogFileStats stats = m_stats;
+        stats.writes += m_file->osWrites;
+        stats.lostBytes += m_file->lostBytes;
+        return stats;
+    }
+
+private:
+    static constexpr auto kBatchLatency = std::chrono::microseconds(LOGGY_FILE_BATCH_LATENCY_US);
+
+    LogFileBackend m_backendKind;
+    std::shared_ptr<loggy_detail::FileBackend> m_file;
+    std::shared_ptr<loggy_detail::FileBackend> m_spare;    // closed backend kept for the next rotation
+    std::filesystem::path m_logFilePath;   // the file being written
+    std::filesystem::path m_pathPattern;   // as given to open(); a strftime pattern with time rotation
+    LogRotateInterval m_interval = LogRotateInterval::Never;
+    std::chrono::seconds m_period{ 0 };    // fixed-length periods instead of m_interval (0: none)
+    LogRotationPolicy m_policy;
+    bool m_compress = false;
+    std::int64_t m_nextPeriod = 0;         // system_clock ticks of the next time rotation (0: none)
+    std::mutex m_mutex;
+    std::atomic<bool> m_open{ false };  // between open() and close(); stays set while setBackend/rotate reopen
+    std::uint64_t m_fileBytes = 0;      // size of the current file including m_batch, counted instead of stat'ed
+    std::string m_batch;
+    std::size_t m_batchLimit = LOGGY_FILE_BATCH_BYTES;
+    std::chrono::steady_clock::time_point m_batchStart{};
+    LogFileStats m_stats;       // `writes` / `lostBytes` exclude the current backend's counters
+    std::uint64_t m_rotations = 0;
+    loggy_detail::MaintenanceThread m_maintenance;  // declared last: stopped (jobs finished) before the rest is destroyed
+
+    void writeLocked(std::string_view line) {
+        if (!m_file->isOpen()) return;
+        ++m_stats.lines;
+
+        // The period boundary is computed once per period; here it is one integer compare
+        if (m_nextPeriod != 0 && std::chrono::system_clock::now().time_since_epoch().count() >= m_nextPeriod) {
+            startNextPeriod();
+        }
+
+        // Rotate before the line that would cross the limit (a single longer line still goes
+        // into a file of its own)
+        const std::uint64_t bytes = line.size() + 1;
+        if (m_fileBytes != 0 && m_policy.maxFileSize != 0 && m_fileBytes + bytes > m_policy.maxFileSize) rotate();
+        m_fileBytes += bytes;
+
+        if (m_file->direct()) {
+            m_file->write(line);
+            m_file->write("\n");
+            m_stats.bytes += bytes;
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (m_batch.empty()) {
+            m_batchStart = now;
+            if (m_batchLimit > 0) m_maintenance.arm(now + kBatchLatency);
+        }
+        m_batch.append(line);
+        m_batch.push_back('\n');
+        if (m_batch.size() >= m_batchLimit || now - m_batchStart >= kBatchLatency) writeBatch();
+    }
+
+    // Maintenance thread, at the age limit of a batch: writes it if no later line or poll()
+    // did (nothing polls the sink in synchronous mode)
+    void writeDueBatch() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_batch.empty()) return;
+        const auto due = m_batchStart + kBatchLatency;
+        if (std::chrono::steady_clock::now() >= due) writeBatch();
+        else m_maintenance.arm(due);
+    }
+
+    void writeBatch() {
+        if (m_batch.empty() || !m_file->isOpen()) return;
+        m_file->write(m_batch);
+        m_stats.bytes += m_batch.size();
+        m_batch.clear();
+    }
+
+    void closeFile() noexcept {
+        if (!m_file->isOpen()) return;
+        try { writeBatch(); }
+        catch (...) {}
+        m_file->close();
+    }
+
+    static void ensureDir(const std::filesystem::path& fp) noexcept {
+        std::error_code ec;
+        const auto dir = fp.has_parent_path() ? fp.parent_path() : std::filesystem::current_path();
+        std::filesystem::create_directories(dir, ec);
+        // Ignore errors silently (best effort)
+    }
+
+    bool timeRotation() const noexcept {
+        return m_interval != LogRotateInterval::Never || m_period.count() > 0;
+    }
+
+    // After a change of the time rotation: an open file moves to the new name at once
+    void reopenForPeriod() {
+        if (!m_file->isOpen()) return;
+        closeFile();
+        openCurrentFile();
+    }
+
+    // (Re)opens the file for the current period, or the plain path without time rotation
+    void openCurrentFile() {
+        m_nextPeriod = 0;
+        if (!timeRotation()) {
+            m_logFilePath = m_pathPattern;
+            ensureDir(m_logFilePath);
+            openLogFile(/*truncate=*/true);
+            return;
+        }
+        m_logFilePath = periodPath();
+        ensureDir(m_logFilePath);
+        openLogFile(/*truncate=*/false);
+    }
+
+    // Renders m_pathPattern for the current period and schedules its end. Reads the clock
+    // writeLocked() compares against: time() may still be in the last period for a moment.
+    std::filesystem::path periodPath() {
+        const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        const std::tm start = loggy_detail::localTime(now);
+        std::ostringstream name;
+        name << std::put_time(&start, m_pathPattern.string().c_str());
+        if (m_period.count() > 0) {
+            const std::time_t length = static_cast<std::time_t>(m_period.count());
+            m_nextPeriod = std::chrono::system_clock::from_time_t(now - now % length + length).time_since_epoch().count();
+            return name.str();
+        }
+
+        std::tm next = start;
+        next.tm_sec = 0;
+        next.tm_min = 0;
+        if (m_interval == LogRotateInterval::Hourly) {
+            next.tm_hour += 1;
+        }
+        else {
+            next.tm_hour = 0;
+            next.tm_mday += 1;
+        }
+        next.tm_isdst = -1;
+        std::time_t boundary = std::mktime(&next);
+        if (boundary <= now) boundary = now - now % 3600 + 3600;   // repeated hour at a DST change
+        m_nextPeriod = std::chrono::system_clock::from_time_t(boundary).time_since_epoch().count();
+        return name.str();
+    }
+
+    // Time rotation: writers go on in the next period's file at once, the old backend is
+    // closed on m_maintenance. Files of past periods keep their names.
+    void startNextPeriod() noexcept {
+        try { writeBatch(); }
+        catch (...) {}
+        try {
+            auto previous = std::exchange(m_logFilePath, periodPath());
+            ensureDir(m_logFilePath);
+            auto old = switchBackend(/*truncate=*/false);
+            // A pattern without the changing fields keeps its name: that file is still active
+            const bool compress = m_compress && previous != m_logFilePath;
+            m_maintenance.post([this, old, kind = m_backendKind, previous, compress, policy = m_policy] {
+                retireBackend(old, kind);
+                if (compress) loggy_detail::compressFile(previous, packedPath(previous));
+                pruneBackups(policy);
+            });
+        }
+        catch (...) {}
+    }
+
+    // Continues in m_logFilePath with the spare backend (or a new one); returns the old one
+    std::shared_ptr<loggy_detail::FileBackend> switchBackend(bool truncate) {
+        // A recycled backend keeps its setup (e.g. the io_uring ring and buffers)
+        auto old = std::exchange(m_file, m_spare ? std::move(m_spare) : loggy_detail::makeFileBackend(m_backendKind));
+        openLogFile(truncate);
+        return old;
+    }
+
+    // Maintenance thread: closes a backend replaced by switchBackend and keeps it as the spare
+    void retireBackend(const std::shared_ptr<loggy_detail::FileBackend>& old, LogFileBackend kind) {
+        if (!old) return;
+        old->close();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.writes += std::exchange(old->osWrites, 0);
+        m_stats.lostBytes += std::exchange(old->lostBytes, 0);
+        if (!m_spare && kind == m_backendKind) m_spare = old;
+    }
+
+    void openLogFile(bool truncate) {
+        m_file->setSizeLimit(m_policy.maxFileSize);
+        if (!m_file->open(m_logFilePath, truncate)) {
+            std::cerr << "[Loggy] Failed to open log file: " << m_logFilePath << std::endl;
+        }
+        if (!m_file->direct()) m_batch.reserve(m_batchLimit + 1024);
+        m_fileBytes = truncate ? 0 : m_file->size();
+    }
+
+    // Only one rename and one open happen here, under the sink's lock: the full file gets a
+    // temporary name and writers continue in a new file right away. Closing the old backend
+    // (which may wait for the disk) and shifting the numbered chain run on m_maintenance.
+    void rotate() noexcept {
+        try { writeBatch(); }
+        catch (...) {}
+        m_fileBytes = 0;            // also after a failed rename or reopen, or every line would retry
+
+        if (m_policy.maxBackups == 0) {
+            closeFile();
+            try { openLogFile(/*truncate=*/true); }
+            catch (...) {}
+            return;
+        }
+
+        std::error_code ec;
+        auto retired = m_logFilePath;
+        retired += ".rotating-" + std::to_string(++m_rotations);
+        std::filesystem::rename(m_logFilePath, retired, ec);
+        if (ec) {
+            // An open file cannot be renamed everywhere (Windows): close it first
+            closeFile();
+            std::filesystem::rename(m_logFilePath, retired, ec);
+        }
+
+        std::shared_ptr<loggy_detail::FileBackend> old;
+        try {
+            if (m_file->isOpen() && m_file->swapsOnRotate()) {
+                m_file->reopen(m_logFilePath);
+            }
+            else {
+                old = switchBackend(/*truncate=*/true);
+            }
+        }
+        catch (...) {}
+
+        try {
+            m_maintenance.post([this, old, kind = m_backendKind, base = m_logFilePath, retired, renamed = !ec,
+                                compress = m_compress, policy = m_policy] {
+                retireBackend(old, kind);
+                if (renamed) shiftBackups(base, retired, compress, policy.maxBackups);
+                pruneBackups(policy);
+            });
+        }
+        catch (...) {}
+    }
+
+    void postRetention() {
+        if (m_policy.maxTotalBytes == 0 && m_policy.maxAge.count() == 0) return;
+        m_maintenance.post([this, policy = m_policy] { pruneBackups(policy); });
+    }
+
+    static std::filesystem::path packedPath(std::filesystem::path path) {
+        path += loggy_detail::kCompressedExtension;
+        return path;
+    }
+
+    static std::filesystem::path backupPath(const std::filesystem::path& base, int index, bool packed) {
+        auto path = base;
+        path += "." + std::to_string(index);
+        return packed ? packedPath(std::move(path)) : path;
+    }
+
+    // Maintenance thread: file.N-1 -> file.N, ..., file.1 -> file.2 (compressed or not), then
+    // `retired` -> file.1, which is compressed afterwards if requested. file.N and above (left
+    // by a larger `backups` before) are deleted.
+    static void shiftBackups(const std::filesystem::path& base, const std::filesystem::path& retired, bool compress,
+        int backups) {
+        std::error_code ec;
+        for (int i = backups; ; ++i) {
+            bool found = false;
+            for (bool packed : { false, true }) found |= std::filesystem::remove(backupPath(base, i, packed), ec);
+            if (!found) break;
+        }
+        for (int i = backups - 1; i >= 1; --i) {
+            for (bool packed : { false, true }) {
+                const auto from = backupPath(base, i, packed);
+                if (std::filesystem::exists(from, ec)) std::filesystem::rename(from, backupPath(base, i + 1, packed), ec);
+            }
+        }
+        const auto first = backupPath(base, 1, false);
+        std::filesystem::rename(retired, first, ec);
+        if (compress && !ec) loggy_detail::compressFile(first, backupPath(base, 1, true));
+    }
+
+    // Maintenance thread: deletes rotated files, oldest first, that are older than
+    // policy.maxAge or do not fit into policy.maxTotalBytes (the current file does not count)
+    void pruneBackups(const LogRotationPolicy& policy) {
+        if (policy.maxTotalBytes == 0 && policy.maxAge.count() == 0) return;
+        std::filesystem::path active;
+        std::string pattern;
+        bool timed = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            active = m_logFilePath;
+            pattern = m_pathPattern.filename().string();
+            timed = timeRotation();
+        }
+        if (active.empty()) return;
+
+        struct Backup {
+            std::filesystem::path path;
+            std::filesystem::file_time_type written;
+            int index;              // backup number (0: none)
+            std::uint64_t size;
+        };
+        std::vector<Backup> backups;
+        std::uint64_t total = 0;
+        std::error_code ec;
+        const auto dir = active.has_parent_path() ? active.parent_path() : std::filesystem::path(".");
+        const auto activeName = active.filename().string();
+        for (std::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            const auto name = it->path().filename().string();
+            if (name == activeName || !it->is_regular_file(ec)) continue;
+            const int index = backupIndex(name, pattern, timed);
+            if (index < 0) continue;
+            Backup backup{ it->path(), it->last_write_time(ec), index, 0 };
+            if (ec) continue;
+            backup.size = static_cast<std::uint64_t>(it->file_size(ec));
+            if (ec) continue;
+            total += backup.size;
+            backups.push_back(std::move(backup));
+        }
+        // Files rotated within one tick of the file system clock share a time; the higher
+        // number is the older one
+        std::sort(backups.begin(), backups.end(), [](const Backup& a, const Backup& b) {
+            return a.written != b.written ? a.written < b.written : a.index > b.index;
+        });
+
+        const auto now = std::filesystem::file_time_type::clock::now();
+        for (const Backup& backup : backups) {
+            const bool expired = policy.maxAge.count() != 0 && now - backup.written > policy.maxAge;
+            const bool over = policy.maxTotalBytes != 0 && total > policy.maxTotalBytes;
+            if (!expired && !over) break;   // the rest is newer
+            if (std::filesystem::remove(backup.path, ec)) total -= backup.size;
+        }
+    }
+
+    // Backup number of `name` if it is the file name (strftime fields in a `timed` pattern
+    // match any run of characters but '.'), optionally followed by a backup number and the
+    // compressed extension: 0 without a number, -1 for other files
+    static int backupIndex(std::string_view name, std::string_view pattern, bool timed) {
+        const std::string_view extension = loggy_detail::kCompressedExtension;
+        if (name.ends_with(extension)) name.remove_suffix(extension.size());
+        const auto matches = [&](std::string_view rest) { return timed ? matchesFields(pattern, rest) : rest == pattern; };
+        if (matches(name)) return 0;
+        const auto dot = name.rfind('.');
+        if (dot == std::string_view::npos) return -1;
+        int index = 0;
+        const auto number = name.substr(dot + 1);
+        const auto [end, err] = std::from_chars(number.data(), number.data() + number.size(), index);
+        if (err != std::errc{} || end != number.data() + number.size() || index <= 0) return -1;
+        return matches(name.substr(0, dot)) ? index : -1;
+    }
+
+    static bool matchesFields(std::string_view pattern, std::string_view name) {
+        while (!pattern.empty()) {
+            if (pattern[0] == '%' && pattern.size() > 1 && pattern[1] != '%') {
+                const bool modified = (pattern[1] == 'E' || pattern[1] == 'O') && pattern.size() > 2;   // %Ey, %Od, ...
+                pattern.remove_prefix(modified ? 3 : 2);
+                for (std::size_t n = 1; n <= name.size() && name[n - 1] != '.'; ++n) {
+                    if (matchesFields(pattern, name.substr(n))) return true;
+                }
+                return false;
+            }
+            const std::size_t literal = pattern.starts_with("%%") ? 2 : 1;
+            if (name.empty() || name[0] != pattern[literal - 1]) return false;
+            pattern.remove_prefix(literal);
+            name.remove_prefix(1);
+        }
+        return name.empty();
+    }
+};
+
+// Hands every line to a callback (Logger::setCustomLogHandler installs one of these)
+class LogCallbackSink : public LogSink {
+public:
+    explicit LogCallbackSink(std::function<void(const std::string&)> callback)
+        : m_callback(std::move(callback)) {
+    }
+
+    void write(LogLevel, std::string_view line) override {
+        thread_local std::string text;  // keeps its capacity, so no allocation per line
+        text.assign(line);
+        m_callback(text);
+    }
+
+private:
+    std::function<void(const std::string&)> m_callback;
+};
+
+// Hands every record in structured form to a callback (Logger::setRecordLogHandler)
+class LogRecordCallbackSink : public LogSink {
+public:
+    explicit LogRecordCallbackSink(std::function<void(const LogRecord&)> callback)
+        : m_callback(std::move(callback)) {
+    }
+
+    [[nodiscard]] bool structured() const noexcept override { return true; }
+    void write(LogLevel, std::string_view) override {}  // not called for structured sinks
+    void writeRecord(const LogRecord& record) override { m_callback(record); }
+
+private:
+    std::function<void(const LogRecord&)> m_callback;
+};
+
+// One line as seen by a batch handler: the formatted line and the fields of its record (as
+// in LogRecord). The string_views point into the sink's buffer and are only valid during the
+// handler call.
+struct LogRecordView {
+    LogLevel level = LogLevel::INFO;
+    std::string_view line;      // formatted, without the trailing '\n'
+    std::chrono::system_clock::time_point time{};
+    std::uint64_t threadId = 0;
+    std::string_view threadName;
+    std::string_view file;      // empty unless logged with LOG_EX / LOGF_EX / source_location
+    int sourceLine = 0;
+    std::string_view function;
+    std::string_view message;   // without layout
+};
+
+// Hands lines to a callback in batches (Logger::setBatchLogHandler installs one of these).
+// Lines are gathered in one buffer; the callback gets them as a span once `maxLines` are
+// pending, the oldest is LOGGY_HANDLER_BATCH_LATENCY_US old, or on flush(). The age is
+// checked on every write and, in async mode, from poll(). Calls are serialized.
+class LogBatchCallbackSink : public LogSink {
+public:
+    explicit LogBatchCallbackSink(std::function<void(std::span<const LogRecordView>)> callback,
+        std::size_t maxLines = LOGGY_HANDLER_BATCH_LINES)
+        : m_callback(std::move(callback)), m_maxLines(std::max<std::size_t>(maxLines, 1)) {
+        m_entries.reserve(m_maxLines);
+        m_outEntries.reserve(m_maxLines);
+        m_views.reserve(m_maxLines);
+    }
+
+    // Lines pending at destruction still go to the callback
+    ~LogBatchCallbackSink() override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        deliver(lock);
+    }
+
+    [[nodiscard]] bool wantsFields() const noexcept override { return true; }
+
+    void writeLine(const LogRecord& record, std::string_view line) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        if (m_entries.empty()) m_batchStart = now;
+        Entry& e = m_entries.emplace_back();
+        e.level = record.level;
+        e.time = record.time;
+        e.threadId = record.threadId;
+        e.sourceLine = record.line;
+        e.line = keep(line);
+        e.threadName = keep(record.threadName);
+        e.file = keep(record.file ? std::string_view(record.file) : std::string_view());
+        e.function = keep(record.function ? std::string_view(record.function) : std::string_view());
+        e.message = keep(record.message);
+        if (m_entries.size() >= m_maxLines || now - m_batchStart >= kBatchLatency) deliver(lock);
+    }
+
+    // Without the fields (a caller other than Logger): only level and line are set
+    void write(LogLevel level, std::string_view line) override {
+        LogRecord record;
+        record.level = level;
+        writeLine(record, line);
+    }
 
-#ifndef LOGGY_MAX_LOG_FILE_SIZE
-#   define LOGGY_MAX_LOG_FILE_SIZE (5ull * 1024ull * 1024ull) // 5 MB
-#endif
+    // Pending lines go to the callback before this returns, unless another thread is in the
+    // callback right now: that thread delivers them as soon as its call returns
+    void flush() override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        deliver(lock);
+    }
 
-#ifndef LOGGY_ROTATE_BACKUPS
-#   define LOGGY_ROTATE_BACKUPS 3                             // keep N old files: file, file.1, file.2, ...
-#endif
+    void poll(std::chrono::steady_clock::time_point now) override {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (lock.owns_lock() && !m_entries.empty() && now - m_batchStart >= kBatchLatency) deliver(lock);
+    }
 
-#ifndef LOGGY_CHECK_INTERVAL
-#   define LOGGY_CHECK_INTERVAL 200                           // check file size every N messages
-#endif
+private:
+    static constexpr auto kBatchLatency = std::chrono::microseconds(LOGGY_HANDLER_BATCH_LATENCY_US);
 
-#ifndef LOGGY_MIN_LEVEL
-#  define LOGGY_MIN_LEVEL 0                                   // 0=DEBUG, 1=INFO, 2=WARN, 3=ERR, 4=FATAL
-#endif
+    // A range of the text buffer
+    struct Text {
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
 
-#ifndef LOGGY_COLORIZE_CONSOLE
-#  define LOGGY_COLORIZE_CONSOLE 1
-#endif
+    struct Entry {
+        LogLevel level = LogLevel::INFO;
+        std::chrono::system_clock::time_point time{};
+        std::uint64_t threadId = 0;
+        int sourceLine = 0;
+        Text line, threadName, file, function, message;
+    };
 
-#ifndef LOGGY_BEST_EFFORT_TRYLOCK
-#  define LOGGY_BEST_EFFORT_TRYLOCK 0                         // set to 1 to skip logs when mutex contended
-#endif
+    std::function<void(std::span<const LogRecordView>)> m_callback;
+    const std::size_t m_maxLines;
+    std::mutex m_mutex;                 // guards the pending batch and the two flags
+    std::string m_text;                 // pending lines and their fields back to back (keeps its capacity)
+    std::vector<Entry> m_entries;       // offsets, since m_text may move while it grows
+    std::chrono::steady_clock::time_point m_batchStart{};
+    bool m_delivering = false;          // a thread is in deliver() (possibly in the callback)
+    bool m_redeliver = false;           // ... and should go round again for lines asked for meanwhile
 
-enum class LogLevel {
-    DEBUG = 0,
-    INFO,
-    WARN,
-    ERR,
-    FATAL
-};
+    // Batch being delivered; only touched by the delivering thread. Swapped with the pending
+    // buffers, so both keep their capacity.
+    std::string m_outText;
+    std::vector<Entry> m_outEntries;
+    std::vector<LogRecordView> m_views;
 
-// Compile-time filter
-constexpr bool loggy_enabled(LogLevel lvl) {
-    return static_cast<int>(lvl) >= LOGGY_MIN_LEVEL;
-}
+    Text keep(std::string_view value) {
+        const Text t{ m_text.size(), value.size() };
+        m_text.append(value);
+        return t;
+    }
+
+    // Takes the pending batch and runs the callback without holding m_mutex, so the callback
+    // may log, flush or add lines from other threads without waiting for itself. Calls stay
+    // serialized: a thread that finds a delivery in progress (including the callback itself)
+    // leaves its lines to the delivering thread.
+    void deliver(std::unique_lock<std::mutex>& lock) {
+        if (m_delivering) {
+            m_redeliver = true;
+            return;
+        }
+        m_delivering = true;
+        do {
+            m_redeliver = false;
+            if (m_entries.empty()) break;
+            m_text.swap(m_outText);
+            m_entries.swap(m_outEntries);
+            lock.unlock();
+            m_views.clear();
+            const std::string_view text(m_outText);
+            auto view = [&](Text t) { return text.substr(t.offset, t.size); };
+            for (const Entry& e : m_outEntries) {
+                m_views.push_back({ e.level, view(e.line), e.time, e.threadId, view(e.threadName), view(e.file),
+                    e.sourceLine, view(e.function), view(e.message) });
+            }
+            try { m_callback(std::span<const LogRecordView>(m_views)); }
+            catch (...) {}
+            m_outText.clear();
+            m_outEntries.clear();
+            lock.lock();
+        } while (m_redeliver);
+        m_delivering = false;
+    }
+};
 
 // -----------------------------
 // Logger
 // -----------------------------
 class Logger {
 public:
-    Logger() = default;
+    Logger() {
+        auto initial = std::make_unique<Config>();
+        initial->sinks.emplace_back(m_consoleSink, /*builtin=*/true);
+        initial->sinks.emplace_back(m_fileSink, /*builtin=*/true);
+        initial->index();
+        m_config.store(initial.get(), std::memory_order_release);
+        m_gateLevel.store(initial->gateLevel, std::memory_order_relaxed);
+        m_currentConfig = std::move(initial);
+    }
+    ~Logger() {
+        stopBackend();
+        std::lock_guard<std::mutex> guard(m_ringsMutex);
+        for (const auto& ring : m_rings) ring->ownerGone.store(true, std::memory_order_release);
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
 
     static Logger& instance() {
         static Logger inst;
@@ -74,36 +3250,176 @@ public:
 
     // Basic setup
     void setLogPath(const std::filesystem::path& path) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_logFilePath = path;
-        ensureDir(path);
-        openLogFile(/*truncate=*/true);
+        m_fileSink->open(path);
+    }
+
+    // Names the calling thread in log lines ([T:name] / %t) instead of its numeric id.
+    // Longer names are truncated to 23 characters; an empty name restores the id.
+    static void setThreadName(std::string_view name) noexcept {
+        loggy_detail::ThreadTag& tag = loggy_detail::currentThreadTag();
+        if (name.empty()) tag.setIdText();
+        else tag.setText(name);
     }
 
-    void enableConsoleOutput(bool enable) noexcept { m_consoleOutput.store(enable, std::memory_order_relaxed); }
-    void enableFileOutput(bool enable)    noexcept { m_fileOutput.store(enable, std::memory_order_relaxed); }
-    void enableAutoFlush(bool enable)     noexcept { m_autoFlush.store(enable, std::memory_order_relaxed); }
-    void setLogLevel(LogLevel level)      noexcept { m_runtimeMinLvl.store(level, std::memory_order_relaxed); }
-    void includeThreadId(bool on)         noexcept { m_includeThreadId.store(on, std::memory_order_relaxed); }
+    // Runtime settings live in an immutable Config; every setter publishes a new version
+    void enableConsoleOutput(bool enable) { updateConfig([&](Config& c) { return exchange(c.find(m_consoleSink.get())->enabled, enable); }); }
+    void enableFileOutput(bool enable)    { updateConfig([&](Config& c) { return exchange(c.find(m_fileSink.get())->enabled, enable); }); }
+    void enableAutoFlush(bool enable)     { updateConfig([&](Config& c) { return exchange(c.autoFlush, enable); }); }
+    void setLogLevel(LogLevel level)      { updateConfig([&](Config& c) { return exchange(c.minLevel, level); }); }
+    void includeThreadId(bool on)         { updateConfig([&](Config& c) { return exchange(c.includeThreadId, on); }); }
 
     void setTimestampFormat(const std::string& format) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_timeFormat = format;
+        updateConfig([&](Config& c) {
+            c.timeFormat = format;
+            if (!c.customPattern) c.pattern = loggy_detail::PatternFormatter::classic(format);
+            return true;
+        });
+    }
+
+    // Line layout, e.g. "%Y-%m-%d %H:%M:%S.%e [%l] [%t] %s:%# %! -> %v" (see
+    // loggy_detail::PatternFormatter). The pattern is compiled once; an empty pattern
+    // restores the built-in layout driven by setTimestampFormat / includeThreadId.
+    void setPattern(const std::string& pattern) {
+        std::shared_ptr<const loggy_detail::PatternFormatter> compiled;
+        if (!pattern.empty()) compiled = std::make_shared<const loggy_detail::PatternFormatter>(pattern);
+        updateConfig([&](Config& c) {
+            c.customPattern = !pattern.empty();
+            c.pattern = compiled ? std::move(compiled) : loggy_detail::PatternFormatter::classic(c.timeFormat);
+            return true;
+        });
     }
 
+    // Installs a LogCallbackSink that receives every line ahead of console and file;
+    // an empty function removes it. Logs made from inside the handler skip it.
     void setCustomLogHandler(std::function<void(const std::string&)> handler) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_customHandler = std::move(handler);
+        std::shared_ptr<LogSink> sink;
+        if (handler) sink = std::make_shared<LogCallbackSink>(std::move(handler));
+        setHandlerSink(std::move(sink));
     }
 
-    void shutdown() noexcept {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_logFile.is_open()) {
-            m_logFile.flush();
-            m_logFile.close();
+    // Like setCustomLogHandler, but the handler gets many lines per call (see
+    // LogBatchCallbackSink), e.g. to take its own lock or do its I/O once per batch.
+    // Replaces a handler set by setCustomLogHandler and vice versa.
+    void setBatchLogHandler(std::function<void(std::span<const LogRecordView>)> handler,
+        std::size_t maxLines = LOGGY_HANDLER_BATCH_LINES) {
+        std::shared_ptr<LogSink> sink;
+        if (handler) sink = std::make_shared<LogBatchCallbackSink>(std::move(handler), maxLines);
+        setHandlerSink(std::move(sink));
+    }
+
+    // Like setCustomLogHandler, but the handler gets the fields of each record (LogRecord)
+    // instead of a formatted line. No layout is formatted for it, so with console and file
+    // output off (or no log file open) lines are never formatted at all. Like the batch
+    // handler, it takes the place of any other handler.
+    void setRecordLogHandler(std::function<void(const LogRecord&)> handler) {
+        std::shared_ptr<LogSink> sink;
+        if (handler) sink = std::make_shared<LogRecordCallbackSink>(std::move(handler));
+        setHandlerSink(std::move(sink));
+    }
+
+    // ---- sinks ----
+    // Every sink has its own minimum level and layout (empty pattern: the logger's layout,
+    // see setPattern). Each distinct layout is formatted once per record, however many
+    // sinks share it. setLogLevel stays a global gate in front of all sinks.
+    // A removed sink is released once no log call or queued record can still reach it (see
+    // reclaimConfigs), possibly on the backend thread.
+    void addSink(std::shared_ptr<LogSink> sink, LogLevel minLevel = LogLevel::DEBUG, const std::string& pattern = {}) {
+        if (!sink) return;
+        auto compiled = compilePattern(pattern);
+        updateConfig([&](Config& c) {
+            SinkEntry* entry = c.find(sink.get());
+            if (!entry) entry = &c.sinks.emplace_back(sink);
+            entry->minLevel = minLevel;
+            entry->pattern = pattern;
+            entry->formatter = std::move(compiled);
+            return true;
+        });
+    }
+
+    void removeSink(const std::shared_ptr<LogSink>& sink) {
+        if (!sink || sink == m_consoleSink || sink == m_fileSink) return;  // built-ins: enable*Output(false)
+        updateConfig([&](Config& c) {
+            const SinkEntry* entry = c.find(sink.get());
+            if (!entry) return false;
+            if (sink == c.handlerSink) c.handlerSink.reset();
+            c.sinks.erase(c.sinks.begin() + (entry - c.sinks.data()));
+            return true;
+        });
+        waitForQueued();
+        callSink([&] { sink->flush(); });
+        reclaimConfigs(/*wait=*/true);
+    }
+
+    void setSinkLevel(const std::shared_ptr<LogSink>& sink, LogLevel minLevel) {
+        updateConfig([&](Config& c) {
+            SinkEntry* entry = c.find(sink.get());
+            return entry && exchange(entry->minLevel, minLevel);
+        });
+    }
+
+    void setSinkPattern(const std::shared_ptr<LogSink>& sink, const std::string& pattern) {
+        auto compiled = compilePattern(pattern);
+        updateConfig([&](Config& c) {
+            SinkEntry* entry = c.find(sink.get());
+            if (!entry) return false;
+            entry->pattern = pattern;
+            entry->formatter = std::move(compiled);
+            return true;
+        });
+    }
+
+    // The built-in sinks behind enableConsoleOutput / setLogPath, e.g. for setSinkLevel
+    [[nodiscard]] const std::shared_ptr<LogConsoleSink>& consoleSink() const noexcept { return m_consoleSink; }
+    [[nodiscard]] const std::shared_ptr<LogFileSink>& fileSink() const noexcept { return m_fileSink; }
+
+    // Async mode: LOG calls only enqueue a record; a backend thread formats it and does
+    // the console/file/handler output. Disabling drains the queue and joins the thread.
+    // With LogQueueMode::PerThread every logging thread gets its own ring on first use.
+    void enableAsync(bool enable, LogQueueMode mode = LogQueueMode::Shared) {
+        std::lock_guard<std::mutex> guard(m_backendMutex);
+        const bool perThread = mode == LogQueueMode::PerThread;
+        if (enable == m_async.load(std::memory_order_relaxed)
+            && (!enable || perThread == m_perThreadQueues.load(std::memory_order_relaxed))) return;
+        stopBackendLocked();
+        if (enable) {
+            if (!m_queue) m_queue = std::make_unique<RecordQueue>(LOGGY_ASYNC_QUEUE_SIZE);
+            m_perThreadQueues.store(perThread, std::memory_order_relaxed);
+            m_stopBackend.store(false, std::memory_order_relaxed);
+            m_backendActive.store(true, std::memory_order_release);
+            m_backend = std::thread(&Logger::backendLoop, this);
+            m_async.store(true, std::memory_order_release);
         }
     }
 
+    // Applies to async mode when a queue is full. Dropped records are counted per level and
+    // reported as a WARN line in the log stream itself.
+    void setOverflowPolicy(LogOverflowPolicy policy, std::size_t growLimitBytes = LOGGY_OVERFLOW_GROW_LIMIT) {
+        updateConfig([&](Config& c) {
+            return exchange(c.overflowPolicy, policy) | exchange(c.growLimit, growLimitBytes);
+        });
+    }
+
+    [[nodiscard]] std::uint64_t droppedMessages(LogLevel level) const noexcept {
+        return m_dropped[static_cast<int>(level)].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t droppedMessages() const noexcept {
+        return m_droppedTotal.load(std::memory_order_relaxed);
+    }
+
+    // Blocks until everything logged by this thread so far has been written, then flushes outputs.
+    void flush() {
+        waitForQueued();
+        flushOutputs();
+    }
+
+    void shutdown() noexcept {
+        stopBackend();
+        try { flushOutputs(); }
+        catch (...) {}
+        m_fileSink->close();
+    }
+
     void initializeConsole(const std::string& title = "Loggy Console") {
 #ifdef _WIN32
         // if there's no console: acquire one
@@ -130,279 +3446,859 @@ public:
 #endif
     }
 
-    // Core log function (stream-style variadic)
-    template <typename... Args>
-    void log(LogLevel level, const char* functionName, const std::string& message, Args&&... args) {
-        if (!loggy_enabled(level)) return;
-        if (level < m_runtimeMinLvl.load(std::memory_order_relaxed)) return;
-
-        // Use ostringstream for variadic arguments (works reliably for all types)
-        std::ostringstream oss;
-        oss << message;
-        (oss << ... << args);
-        submit(level, functionName, nullptr, 0, oss.str());
+    // Core log function (stream-style variadic). Arguments are captured in binary form
+    // and only converted to text when the record is written (see loggy_detail::encodeArgs).
+    template <typename Msg, typename... Args>
+    void log(LogLevel level, LogSourceName functionName, Msg&& message, Args&&... args) {
+        if (!loggy_enabled(level) || level < m_gateLevel.load(std::memory_order_relaxed)) return;
+        ConfigReader reader(*this);
+        const Config& cfg = reader.config();
+        if (level < cfg.gateLevel) return;
+        submit<Msg, Args...>(cfg, level, functionName, {}, 0, loggy_detail::concatArgs<Msg, Args...>, message, args...);
     }
 
     // Extended: include file:line
-    template <typename... Args>
-    void logEx(LogLevel level, const char* functionName, const char* file, int line,
-        const std::string& message, Args&&... args)
+    template <typename Msg, typename... Args>
+    void logEx(LogLevel level, LogSourceName functionName, LogSourceName file, int line,
+        Msg&& message, Args&&... args)
     {
-        if (!loggy_enabled(level)) return;
-        if (level < m_runtimeMinLvl.load(std::memory_order_relaxed)) return;
-
-        // Use ostringstream for variadic arguments (works reliably for all types)
-        std::ostringstream oss;
-        oss << message;
-        (oss << ... << args);
-        submit(level, functionName, file, line, oss.str());
+        if (!loggy_enabled(level) || level < m_gateLevel.load(std::memory_order_relaxed)) return;
+        ConfigReader reader(*this);
+        const Config& cfg = reader.config();
+        if (level < cfg.gateLevel) return;
+        submit<Msg, Args...>(cfg, level, functionName, file, line, loggy_detail::concatArgs<Msg, Args...>, message, args...);
     }
 
-    // Simple convenience
-    void log(LogLevel level, const char* functionName, const std::string& message) {
-        if (!loggy_enabled(level)) return;
-        if (level < m_runtimeMinLvl.load(std::memory_order_relaxed)) return;
-        submit(level, functionName, nullptr, 0, message);
+    // `{}` format variant used by LOGF / LOGF_EX; Fmt supplies the format string as
+    // `static constexpr std::string_view str()`, which is parsed at compile time.
+    template <typename Fmt, typename... Args>
+    void logf(LogLevel level, LogSourceName functionName, LogSourceName file, int line, Args&&... args) {
+        using Compiled = loggy_detail::CompiledFormat<Fmt>;
+        static_assert(Compiled::info.valid, "LOGF: malformed format string (only {} placeholders and {{ }} escapes)");
+        static_assert(Compiled::info.placeholders == sizeof...(Args),
+            "LOGF: number of {} placeholders does not match the number of arguments");
+        if (!loggy_enabled(level) || level < m_gateLevel.load(std::memory_order_relaxed)) return;
+        ConfigReader reader(*this);
+        const Config& cfg = reader.config();
+        if (level < cfg.gateLevel) return;
+        submit<Args...>(cfg, level, functionName, file, line, loggy_detail::compiledArgs<Compiled, Args...>, args...);
     }
 
     // Modern C++20/23 variant using source_location
     template <typename... Args>
     void log(LogLevel level, const std::string& message, Args&&... args,
         const std::source_location& loc = std::source_location::current()) {
-        if (!loggy_enabled(level)) return;
-        if (level < m_runtimeMinLvl.load(std::memory_order_relaxed)) return;
-
-        // Use ostringstream for variadic arguments (works reliably for all types)
-        std::ostringstream oss;
-        oss << message;
-        (oss << ... << args);
-        submit(level, loc.function_name(), loc.file_name(), static_cast<int>(loc.line()), oss.str());
+        if (!loggy_enabled(level) || level < m_gateLevel.load(std::memory_order_relaxed)) return;
+        ConfigReader reader(*this);
+        const Config& cfg = reader.config();
+        if (level < cfg.gateLevel) return;
+        submit<const std::string&, Args...>(cfg, level, LogSourceName::persistent(loc.function_name()),
+            LogSourceName::persistent(loc.file_name()), static_cast<int>(loc.line()),
+            loggy_detail::concatArgs<const std::string&, Args...>, message, args...);
     }
 
 private:
-    inline static thread_local bool m_inHandler = false;
-
-    std::ofstream m_logFile;
-    std::filesystem::path m_logFilePath;
-    std::mutex m_mutex;
+    // Snapshot of all runtime settings. Never modified after publication: setters copy the
+    // current version, change the copy and publish it with one atomic store, so a log call
+    // sees a consistent configuration through a single acquire load, without lock or copies.
+    // One registered sink with its threshold and layout
+    struct SinkEntry {
+        explicit SinkEntry(std::shared_ptr<LogSink> s, bool isBuiltin = false)
+            : sink(std::move(s)), builtin(isBuiltin), structured(sink->structured()), fields(sink->wantsFields()) {
+        }
 
-    std::atomic<size_t> m_lineCount{ 0 };
+        std::shared_ptr<LogSink> sink;
+        LogLevel minLevel = LogLevel::DEBUG;
+        bool builtin = false;   // console / file: also receive logs made from inside other sinks
+        bool structured = false; // LogSink::structured: gets the record, belongs to no layout
+        bool fields = false;    // LogSink::wantsFields: gets the line together with the record
+        bool enabled = true;    // enableConsoleOutput / enableFileOutput
+        std::string pattern;    // empty: the logger's layout
+        std::shared_ptr<const loggy_detail::PatternFormatter> formatter;
+    };
 
-    std::atomic<LogLevel> m_runtimeMinLvl{ LogLevel::DEBUG };
-    std::atomic<bool> m_consoleOutput{ true };
-    std::atomic<bool> m_fileOutput{ true };
-    std::atomic<bool> m_autoFlush{ false };
-    std::atomic<bool> m_includeThreadId{ true };
+    // Sinks grouped by layout, so each layout is formatted at most once per record
+    struct Layout {
+        Layout(std::string p, std::shared_ptr<const loggy_detail::PatternFormatter> f)
+            : pattern(std::move(p)), formatter(std::move(f)) {
+        }
 
-    std::string m_timeFormat = "%Y-%m-%d %H:%M:%S";
-    std::function<void(const std::string&)> m_customHandler = nullptr;
+        std::string pattern;
+        std::shared_ptr<const loggy_detail::PatternFormatter> formatter;
+        LogLevel minLevel = LogLevel::FATAL;    // lowest level any of its sinks accepts
+        std::vector<std::size_t> sinks;         // indices into Config::sinks
+    };
 
-    // ---- core submit path with locking ----
-    void submit(LogLevel level, const char* func, const char* file, int line, const std::string& msg) {
-        std::string out;
-        std::function<void(const std::string&)> handler;
-        bool doConsole = false;
-        bool doFile = false;
+    struct Config {
+        LogLevel minLevel = LogLevel::DEBUG;
         bool autoFlush = false;
-        bool includeThreadId = false;
-        std::string timeFormat;
+        bool includeThreadId = true;
+        LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Block;
+        std::size_t growLimit = LOGGY_OVERFLOW_GROW_LIMIT;
+        std::string timeFormat = "%Y-%m-%d %H:%M:%S";
+        bool customPattern = false;
+        std::shared_ptr<const loggy_detail::PatternFormatter> pattern = loggy_detail::PatternFormatter::classic(timeFormat);
+        std::vector<SinkEntry> sinks;
+        std::shared_ptr<LogSink> handlerSink;   // the sink installed by setCustomLogHandler
 
-#if LOGGY_BEST_EFFORT_TRYLOCK
-        if (!m_mutex.try_lock()) return;
-        std::unique_lock<std::mutex> lock(m_mutex, std::adopt_lock);
-#else
-        std::unique_lock<std::mutex> lock(m_mutex);
-#endif
-        {
-            // Format and copy necessary state while holding the lock
-            includeThreadId = m_includeThreadId.load(std::memory_order_relaxed);
-            timeFormat = m_timeFormat;
-            out = formatLine(level, func, file, line, msg, includeThreadId, timeFormat);
-            handler = m_customHandler;
-            doConsole = m_consoleOutput.load(std::memory_order_relaxed);
-            doFile = m_fileOutput.load(std::memory_order_relaxed);
-            autoFlush = m_autoFlush.load(std::memory_order_relaxed);
-        }
-        lock.unlock(); // Release lock early for I/O operations
-
-        if (handler && !m_inHandler) {
-            m_inHandler = true;
-            try { handler(out); }
-            catch (...) {}
-            m_inHandler = false;
+        // Derived by index() before publication
+        std::vector<Layout> layouts;            // [0] is the logger's layout
+        std::vector<std::size_t> recordSinks;   // structured sinks, indices into sinks
+        LogLevel gateLevel = LogLevel::DEBUG;   // below this no enabled sink wants the record
+
+        [[nodiscard]] SinkEntry* find(const LogSink* sink) noexcept {
+            for (auto& entry : sinks)
+                if (entry.sink.get() == sink) return &entry;
+            return nullptr;
         }
 
-#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
-        if (doConsole) {
-            setConsoleColor(level);
-            std::cout << out << '\n';
-            if (autoFlush) std::cout.flush();
-            resetConsoleColor();
+        void index() {
+            layouts.clear();
+            layouts.emplace_back(std::string(), pattern);
+            recordSinks.clear();
+            LogLevel lowest = LogLevel::FATAL;
+            for (std::size_t i = 0; i < sinks.size(); ++i) {
+                const SinkEntry& entry = sinks[i];
+                if (!entry.enabled) continue;
+                lowest = std::min(lowest, entry.minLevel);
+                if (entry.structured) {
+                    recordSinks.push_back(i);
+                    continue;
+                }
+                std::size_t layout = 0;
+                if (entry.formatter) {
+                    while (layout < layouts.size() && layouts[layout].pattern != entry.pattern) ++layout;
+                    if (layout == layouts.size()) layouts.emplace_back(entry.pattern, entry.formatter);
+                }
+                layouts[layout].sinks.push_back(i);
+                layouts[layout].minLevel = std::min(layouts[layout].minLevel, entry.minLevel);
+            }
+            gateLevel = std::max(minLevel, lowest);
         }
-#else
-        if (doConsole) {
-            std::cout << out << '\n';
-            if (autoFlush) std::cout.flush();
+    };
+
+    template <typename T>
+    static bool exchange(T& field, T value) {
+        if (field == value) return false;
+        field = value;
+        return true;
+    }
+
+    // One log call as handed from the calling thread to the output path.
+    struct Record {
+        enum class Kind : std::uint8_t { Log, Flush };
+
+        Kind kind = Kind::Log;
+        LogLevel level = LogLevel::INFO;
+        int line = 0;
+        const char* func = nullptr; // static storage, or a copy inside `args` (see keepName)
+        const char* file = nullptr;
+        std::int32_t funcCopy = -1; // offset of the copied name in `args` (-1: use the pointer)
+        std::int32_t fileCopy = -1;
+        std::chrono::system_clock::time_point time{};
+        loggy_detail::ThreadTag thread;
+        std::uint64_t flushSeq = 0;
+        const Config* config = nullptr; // settings in effect at the log call (kept while queued, see m_drainedEpoch)
+        loggy_detail::FormatArgsFn formatArgs = nullptr;
+        loggy_detail::ArgBuffer args;   // raw argument bytes, decoded by formatArgs
+
+        void formatMessage(std::string& out) const {
+            if (formatArgs) formatArgs(args.data(), out);
         }
-#endif
 
-        if (doFile) {
-            lock.lock(); // Re-acquire lock for file operations
-            if (m_logFile.is_open()) {
-                if (++m_lineCount % LOGGY_CHECK_INTERVAL == 0) rotateIfNeeded();
-                m_logFile << out << '\n';
-                if (autoFlush) m_logFile.flush();
+        [[nodiscard]] const char* function() const noexcept { return funcCopy < 0 ? func : args.data() + funcCopy; }
+        [[nodiscard]] const char* fileName() const noexcept { return fileCopy < 0 ? file : args.data() + fileCopy; }
+
+        // Before the record leaves the calling thread: names that may not outlive the log
+        // call are copied behind the argument bytes
+        void keepNames(LogSourceName funcName, LogSourceName fileName) {
+            if (!funcName.isPersistent()) funcCopy = keepName(func);
+            if (!fileName.isPersistent()) fileCopy = keepName(file);
+        }
+
+    private:
+        std::int32_t keepName(const char* name) {
+            const auto offset = static_cast<std::int32_t>(args.size());
+            args.append(name, std::strlen(name) + 1);
+            return offset;
+        }
+    };
+    using RecordQueue = loggy_detail::BoundedQueue<Record>;
+    static constexpr int kLevelCount = 5;
+
+    // Records spilled by LogOverflowPolicy::Grow. While `active`, the owning queue's producers
+    // append here too so per-thread order is kept; the backend takes the whole list at once.
+    struct OverflowList {
+        std::mutex mutex;
+        std::deque<Record> records;
+        std::size_t bytes = 0;
+        std::atomic<bool> active{ false };
+    };
+
+    // Ring owned by one producer thread; it outlives the thread until the backend drained it.
+    // `consumerMutex` lets the producer act as a second consumer for LogOverflowPolicy::DropOldest.
+    struct ThreadRing {
+        explicit ThreadRing(std::size_t capacity) : ring(capacity) {}
+        loggy_detail::SpscRing<Record> ring;
+        std::mutex consumerMutex;
+        OverflowList overflow;
+        std::atomic<bool> abandoned{ false };   // the producer thread exited
+        std::atomic<bool> ownerGone{ false };   // the Logger was destroyed
+    };
+
+    // thread_local list of the calling thread's rings, one per PerThread logger it logs to
+    // (registered lazily on first log), so alternating between loggers keeps each ring
+    struct ThreadRings {
+        struct Entry {
+            std::uint64_t ownerId = 0;
+            std::shared_ptr<ThreadRing> ring;
+        };
+
+        std::vector<Entry> entries;
+        std::size_t last = 0;   // entry of the previous call
+
+        ~ThreadRings() {
+            for (const Entry& entry : entries) entry.ring->abandoned.store(true, std::memory_order_release);
+        }
+    };
+
+    inline static thread_local bool m_inSink = false;
+    inline static thread_local bool m_onBackend = false;
+    inline static std::atomic<std::uint64_t> s_nextLoggerId{ 1 };
+
+    std::shared_ptr<LogConsoleSink> m_consoleSink = std::make_shared<LogConsoleSink>();
+    std::shared_ptr<LogFileSink> m_fileSink = std::make_shared<LogFileSink>();
+
+    // ---- configuration (RCU-style) ----
+    // Setters that change nothing publish nothing. A replaced version is retired and freed
+    // once no log call can still be reading it and no queued record refers to it.
+    struct RetiredConfig {
+        std::unique_ptr<const Config> config;
+        std::uint64_t epoch = 0;                // loggy_detail::Epochs, taken after the replacement was published
+    };
+
+    std::mutex m_configMutex;                  // serializes setters, guards the members below
+    std::unique_ptr<const Config> m_currentConfig;
+    std::vector<RetiredConfig> m_retiredConfigs;
+    std::atomic<const Config*> m_config{ nullptr };
+    std::atomic<LogLevel> m_gateLevel{ LogLevel::DEBUG }; // m_config->gateLevel, checked before entering a section
+    std::atomic<bool> m_reclaimPending{ false };            // m_retiredConfigs is not empty
+
+    // Read-side section around every use of the current version: versions it may have seen
+    // stay allocated until it ends. A section that ends while versions wait tries to free them.
+    class ConfigReader {
+    public:
+        explicit ConfigReader(Logger& logger) : m_logger(logger) { loggy_detail::Epochs::enter(); }
+        ~ConfigReader() {
+            if (loggy_detail::Epochs::leave() && m_logger.m_reclaimPending.load(std::memory_order_relaxed))
+                m_logger.reclaimConfigs(/*wait=*/false);
+        }
+
+        ConfigReader(const ConfigReader&) = delete;
+        ConfigReader& operator=(const ConfigReader&) = delete;
+
+        // seq_cst: ordered after the epoch announcement in Epochs::enter
+        [[nodiscard]] const Config& config() const noexcept {
+            return *m_logger.m_config.load(std::memory_order_seq_cst);
+        }
+
+    private:
+        Logger& m_logger;
+    };
+
+    void setHandlerSink(std::shared_ptr<LogSink> sink) {
+        std::shared_ptr<LogSink> previous;
+        updateConfig([&](Config& c) {
+            previous = c.handlerSink;
+            if (c.handlerSink) c.sinks.erase(c.sinks.begin() + (c.find(c.handlerSink.get()) - c.sinks.data()));
+            c.handlerSink = sink;
+            if (sink) c.sinks.emplace(c.sinks.begin(), sink);
+            return true;
+        });
+        if (!previous) return;
+        waitForQueued();    // records queued before the switch still go to `previous`
+        callSink([&] { previous->flush(); });   // hand over what a batch handler still holds
+        reclaimConfigs(/*wait=*/true);
+    }
+
+    static std::shared_ptr<const loggy_detail::PatternFormatter> compilePattern(const std::string& pattern) {
+        if (pattern.empty()) return nullptr;
+        return std::make_shared<const loggy_detail::PatternFormatter>(pattern);
+    }
+
+    // `change` edits a copy of the current version and returns whether anything changed
+    template <typename Change>
+    void updateConfig(Change&& change) {
+        {
+            std::lock_guard<std::mutex> guard(m_configMutex);
+            auto next = std::make_unique<Config>(*m_currentConfig);
+            if (!change(*next)) return;
+            next->index();
+            m_retiredConfigs.reserve(m_retiredConfigs.size() + 1);
+            m_config.store(next.get(), std::memory_order_seq_cst);
+            m_gateLevel.store(next->gateLevel, std::memory_order_relaxed);
+            const std::uint64_t epoch = loggy_detail::Epochs::advance();
+            m_retiredConfigs.push_back({ std::move(m_currentConfig), epoch });
+            m_currentConfig = std::move(next);
+            m_reclaimPending.store(true, std::memory_order_relaxed);
+        }
+        reclaimConfigs(/*wait=*/true);
+    }
+
+    // Frees the retired versions no reader can reach any more: every section that could
+    // have loaded one has ended, and the records those sections queued are written (the
+    // backend has drained past the version's epoch, or no backend runs and the queues are
+    // empty). Without `wait` gives up if a setter holds the lock. The versions are destroyed
+    // outside the lock, as a released sink's destructor may log.
+    void reclaimConfigs(bool wait) noexcept {
+        std::vector<RetiredConfig> freed;
+        {
+            std::unique_lock<std::mutex> lock(m_configMutex, std::defer_lock);
+            if (wait) lock.lock();
+            else if (!lock.try_lock()) return;
+            if (m_retiredConfigs.empty()) return;
+            const std::uint64_t oldest = loggy_detail::Epochs::oldestActive();
+            // Read after the scan: records of the sections seen ended are in the queues by now
+            const std::uint64_t written = m_backendActive.load(std::memory_order_acquire) || !queuesEmpty()
+                ? m_drainedEpoch.load(std::memory_order_acquire)
+                : std::numeric_limits<std::uint64_t>::max();
+            const auto kept = std::partition(m_retiredConfigs.begin(), m_retiredConfigs.end(), [&](const RetiredConfig& r) {
+                return r.epoch > oldest || r.epoch > written;
+            });
+            try {
+                freed.assign(std::make_move_iterator(kept), std::make_move_iterator(m_retiredConfigs.end()));
+                m_retiredConfigs.erase(kept, m_retiredConfigs.end());
             }
+            catch (...) {}  // nothing erased; the next attempt frees them
+            m_reclaimPending.store(!m_retiredConfigs.empty(), std::memory_order_relaxed);
         }
     }
 
-    // ---- formatting ----
-    std::string formatLine(LogLevel level, const char* func, const char* file, int line,
-        const std::string& msg, bool includeThreadId, const std::string& timeFormat) const {
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-        std::tm tm{};
-#if defined(_MSC_VER)
-        if (localtime_s(&tm, &now_c) != 0) {
-            // Error handling: use current time as fallback
-            std::time(&now_c);
-            localtime_s(&tm, &now_c);
+    // ---- async backend state ----
+    std::mutex m_backendMutex;                 // serializes enableAsync / shutdown
+    std::unique_ptr<RecordQueue> m_queue;      // created once, kept until destruction
+    std::thread m_backend;
+    std::atomic<bool> m_backendActive{ false };    // from the backend's start until stopBackendLocked drained the queues
+    std::atomic<std::uint64_t> m_drainedEpoch{ 0 }; // retired versions up to this epoch have no records left in the queues
+    std::atomic<bool> m_async{ false };
+    std::atomic<bool> m_perThreadQueues{ false };
+    std::atomic<bool> m_stopBackend{ false };
+
+    std::atomic<std::size_t> m_overflowBytes{ 0 };
+    OverflowList m_overflow;                   // spill list of the shared queue
+
+    // Drop accounting; the *Reported/m_droppedSeen values are only written under m_dropReportMutex
+    std::mutex m_dropReportMutex;
+    std::atomic<std::uint64_t> m_dropped[kLevelCount]{};
+    std::atomic<std::uint64_t> m_droppedTotal{ 0 };
+    std::atomic<std::uint64_t> m_droppedReported{ 0 };
+    std::uint64_t m_droppedSeen[kLevelCount]{};
+    std::chrono::steady_clock::time_point m_nextDropReport{};
+
+    const std::uint64_t m_id = s_nextLoggerId.fetch_add(1, std::memory_order_relaxed);
+    std::mutex m_ringsMutex;                   // guards m_rings (registration / reaping only)
+    std::vector<std::shared_ptr<ThreadRing>> m_rings;
+    std::atomic<std::uint64_t> m_ringsVersion{ 0 };
+
+    std::mutex m_wakeMutex;                    // guards m_flushCompleted, backend idle waits
+    std::condition_variable m_wakeCv;
+    std::condition_variable m_flushCv;
+    std::atomic<std::uint64_t> m_flushRequested{ 0 };
+    std::uint64_t m_flushCompleted = 0;
+    std::uint64_t m_flushSeen = 0;             // consumer side: markers 1..m_flushSeen were taken from the queues
+    std::vector<std::uint64_t> m_flushAhead;   // consumer side: markers taken past a gap
+    std::uint64_t m_flushDone = 0;             // consumer side: highest flush finished
+
+    // ---- core submit path ----
+    // Args are given explicitly as the log call deduced them, so the encoding matches formatArgs
+    template <typename... Args>
+    void submit(const Config& cfg, LogLevel level, LogSourceName func, LogSourceName file, int line,
+        loggy_detail::FormatArgsFn formatArgs, const std::remove_reference_t<Args>&... args) {
+        Record rec;
+        rec.level = level;
+        rec.func = func.c_str();
+        rec.file = file.c_str();
+        rec.line = line;
+        rec.time = std::chrono::system_clock::now();
+        rec.thread = loggy_detail::currentThreadTag();
+        rec.config = &cfg;
+        rec.formatArgs = formatArgs;
+        loggy_detail::encodeArgs<Args...>(rec.args, args...);
+
+        // The backend delivers its own (handler) logs directly: it cannot wait on itself.
+        if (m_async.load(std::memory_order_acquire) && !m_onBackend) {
+            rec.keepNames(func, file);
+            enqueue(std::move(rec), cfg.overflowPolicy);
+            return;
         }
-#else
-        if (localtime_r(&now_c, &tm) == nullptr) {
-            // Error handling: use current time as fallback
-            std::time(&now_c);
-            localtime_r(&now_c, &tm);
+        if (dropsPending()) reportDrops(cfg, /*force=*/false);
+        writeRecord(rec, cfg, /*bestEffort=*/LOGGY_BEST_EFFORT_TRYLOCK != 0);
+    }
+
+    void enqueue(Record&& rec, LogOverflowPolicy policy) {
+        if (m_perThreadQueues.load(std::memory_order_relaxed)) {
+            ThreadRing& ring = threadRing();
+            pushRecord(ring.ring, ring.overflow, std::move(rec), policy, [&ring](Record& victim) {
+                std::lock_guard<std::mutex> guard(ring.consumerMutex);
+                return ring.ring.tryPop(victim);
+            });
+            return;
         }
-#endif
+        pushRecord(*m_queue, m_overflow, std::move(rec), policy, [this](Record& victim) {
+            return m_queue->tryPop(victim);
+        });
+    }
 
-#if __cpp_lib_format >= 202207L
-        try {
-            std::ostringstream time_oss;
-            time_oss << std::put_time(&tm, timeFormat.c_str());
-            std::string formatted = time_oss.str();
-            formatted += std::format(" [{}]", levelToStr(level));
-            if (includeThreadId) {
-                formatted += std::format(" [T:{}]", std::this_thread::get_id());
-            }
-            if (file && *file) {
-                formatted += std::format(" [{}:{}]", file, line);
+    template <typename Queue, typename PopOldest>
+    void pushRecord(Queue& queue, OverflowList& overflow, Record&& rec, LogOverflowPolicy policy, PopOldest popOldest) {
+        const bool marker = rec.kind == Record::Kind::Flush; // flush requests are never dropped
+        if (overflow.active.load(std::memory_order_acquire)) {
+            // Stay behind the records already spilled
+            if (!pushOverflow(overflow, std::move(rec), marker)) countDropped(rec.level);
+            return;
+        }
+        while (!queue.tryPush(std::move(rec))) {
+            switch (policy) {
+            case LogOverflowPolicy::DropNewest:
+                countDropped(rec.level);
+                return;
+            case LogOverflowPolicy::DropOldest: {
+                Record victim;
+                if (!popOldest(victim)) break;
+                if (victim.kind == Record::Kind::Flush) {
+                    // Keep the evicted flush request; it moves behind `rec`, which is still correct
+                    while (!queue.tryPush(std::move(rec))) waitForSpace();
+                    while (!queue.tryPush(std::move(victim))) waitForSpace();
+                    return;
+                }
+                countDropped(victim.level);
+                break;
             }
-            if (func && *func) {
-                formatted += std::format(" {} -> {}", func, msg);
+            case LogOverflowPolicy::Grow:
+                if (!pushOverflow(overflow, std::move(rec), marker)) countDropped(rec.level);
+                return;
+            case LogOverflowPolicy::Block:
+            default:
+                waitForSpace();
+                break;
             }
-            else {
-                formatted += std::format(" {}", msg);
+        }
+    }
+
+    bool pushOverflow(OverflowList& overflow, Record&& rec, bool ignoreLimit) {
+        const std::size_t bytes = sizeof(Record) + rec.args.capacity();
+        std::lock_guard<std::mutex> guard(overflow.mutex);
+        if (!ignoreLimit
+            && m_overflowBytes.load(std::memory_order_relaxed) + bytes > rec.config->growLimit) {
+            return false;
+        }
+        m_overflowBytes.fetch_add(bytes, std::memory_order_relaxed);
+        overflow.bytes += bytes;
+        overflow.records.push_back(std::move(rec));
+        overflow.active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // Backend side: takes the whole spill list; the queue it belongs to must be drained first.
+    bool drainOverflow(OverflowList& overflow) {
+        if (!overflow.active.load(std::memory_order_acquire)) return false;
+        std::deque<Record> taken;
+        {
+            std::lock_guard<std::mutex> guard(overflow.mutex);
+            taken.swap(overflow.records);
+            m_overflowBytes.fetch_sub(overflow.bytes, std::memory_order_relaxed);
+            overflow.bytes = 0;
+            overflow.active.store(false, std::memory_order_release);
+        }
+        for (auto& rec : taken) processQueued(rec);
+        return !taken.empty();
+    }
+
+    void countDropped(LogLevel level) noexcept {
+        m_dropped[static_cast<int>(level)].fetch_add(1, std::memory_order_relaxed);
+        m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool dropsPending() const noexcept {
+        return m_droppedTotal.load(std::memory_order_relaxed) != m_droppedReported.load(std::memory_order_relaxed);
+    }
+
+    // Writes "N messages dropped" into the log stream, at most once per LOGGY_DROP_REPORT_INTERVAL_MS
+    // unless forced.
+    void reportDrops(const Config& cfg, bool force) {
+        std::uint64_t total = 0;
+        std::ostringstream detail;
+        {
+            std::lock_guard<std::mutex> guard(m_dropReportMutex);
+            const auto now = std::chrono::steady_clock::now();
+            if (!force && now < m_nextDropReport) return;
+            m_nextDropReport = now + std::chrono::milliseconds(LOGGY_DROP_REPORT_INTERVAL_MS);
+
+            for (int i = 0; i < kLevelCount; ++i) {
+                const std::uint64_t count = m_dropped[i].load(std::memory_order_relaxed);
+                const std::uint64_t delta = count - m_droppedSeen[i];
+                m_droppedSeen[i] = count;
+                if (delta == 0) continue;
+                detail << (total ? ", " : "") << levelToStr(static_cast<LogLevel>(i)) << ": " << delta;
+                total += delta;
             }
-            return formatted;
+            m_droppedReported.fetch_add(total, std::memory_order_relaxed);
         }
-        catch (...) {
-            // Fallback to ostringstream
+        if (total == 0) return;
+
+        Record rec;
+        rec.level = LogLevel::WARN;
+        rec.func = "Loggy";
+        rec.time = std::chrono::system_clock::now();
+        rec.thread = loggy_detail::currentThreadTag();
+        const std::string text = std::to_string(total) + " messages dropped (" + detail.str() + ")";
+        rec.formatArgs = loggy_detail::concatArgs<std::string>;
+        loggy_detail::encodeArgs<std::string>(rec.args, text);
+        writeRecord(rec, cfg, /*bestEffort=*/false);
+    }
+
+    void reportDropsNow(bool force) {
+        if (!dropsPending()) return;
+        ConfigReader reader(*this);
+        reportDrops(reader.config(), force);
+    }
+
+    // Queue full: make sure the backend is awake and wait for a free slot
+    void waitForSpace() {
+        m_wakeCv.notify_one();
+        std::this_thread::yield();
+    }
+
+    ThreadRing& threadRing() {
+        static thread_local ThreadRings rings;
+        auto& entries = rings.entries;
+        if (rings.last < entries.size() && entries[rings.last].ownerId == m_id) return *entries[rings.last].ring;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].ownerId != m_id) continue;
+            rings.last = i;
+            return *entries[i].ring;
         }
-#endif
-        // Fallback to ostringstream (always available or if format failed)
-        std::ostringstream oss;
-        oss << std::put_time(&tm, timeFormat.c_str())
-            << " [" << levelToStr(level) << "]";
-        if (includeThreadId) {
-            oss << " [T:" << std::this_thread::get_id() << "]";
+
+        // First log of this thread into this logger. Logger ids are never reused, so rings
+        // of destroyed loggers are only dropped here.
+        std::erase_if(entries, [](const ThreadRings::Entry& e) { return e.ring->ownerGone.load(std::memory_order_acquire); });
+        entries.reserve(entries.size() + 1);
+        auto ring = std::make_shared<ThreadRing>(LOGGY_THREAD_QUEUE_SIZE);
+        {
+            std::lock_guard<std::mutex> guard(m_ringsMutex);
+            m_rings.push_back(ring);
         }
-        if (file && *file) {
-            oss << " [" << file << ":" << line << "]";
+        m_ringsVersion.fetch_add(1, std::memory_order_release);
+        entries.push_back({ m_id, std::move(ring) });
+        rings.last = entries.size() - 1;
+        return *entries.back().ring;
+    }
+
+    // Formats one record and hands it to every sink that accepts its level. Formatting needs
+    // no lock: the config snapshot is immutable and the buffers and timestamp caches are per
+    // thread. A layout is only formatted if a ready() text sink wants the line; structured
+    // sinks get the fields. With `bestEffort` a sink that would block skips the line (counted
+    // as a drop).
+    void writeRecord(const Record& rec, const Config& cfg, bool bestEffort) {
+        // Reused per thread; the second set serves logs made from inside a sink (e.g. the handler)
+        thread_local std::vector<std::string> lineBuffers[2];
+        thread_local std::string msgBuffers[2];
+        const bool nested = m_inSink;
+        std::vector<std::string>& lines = lineBuffers[nested ? 1 : 0];
+        std::string& msg = msgBuffers[nested ? 1 : 0];
+        if (lines.size() < cfg.layouts.size()) lines.resize(cfg.layouts.size());
+        msg.clear();
+
+        rec.formatMessage(msg);
+        loggy_detail::LineFields fields;
+        fields.level = rec.level;
+        fields.time = rec.time;
+        fields.threadId = rec.thread.id;
+        fields.threadText = rec.thread.view();
+        fields.file = rec.fileName();
+        fields.line = rec.line;
+        fields.func = rec.function();
+        fields.msg = msg;
+
+        LogRecord record;
+        record.time = rec.time;
+        record.level = rec.level;
+        record.threadId = rec.thread.id;
+        record.threadName = fields.threadText;
+        record.file = fields.file;
+        record.line = rec.line;
+        record.function = fields.func;
+        record.message = msg;
+
+        // Structured sinks take the fields as they are (none is built-in, so none when nested)
+        if (!nested && !cfg.recordSinks.empty()) {
+            for (std::size_t index : cfg.recordSinks) {
+                const SinkEntry& entry = cfg.sinks[index];
+                if (rec.level < entry.minLevel) continue;
+                callSink([&] {
+                    entry.sink->writeRecord(record);
+                    if (cfg.autoFlush && !m_onBackend) entry.sink->flush();
+                });
+            }
         }
-        if (func && *func) {
-            oss << " " << func << " -> ";
+
+        bool skipped = false;
+        for (std::size_t i = 0; i < cfg.layouts.size(); ++i) {
+            const Layout& layout = cfg.layouts[i];
+            if (rec.level < layout.minLevel) continue;
+            std::string& out = lines[i];
+            bool formatted = false;
+            for (std::size_t index : layout.sinks) {
+                const SinkEntry& entry = cfg.sinks[index];
+                // A sink logging from inside write() only reaches the built-in sinks
+                if (rec.level < entry.minLevel || (nested && !entry.builtin)) continue;
+                if (!entry.sink->ready()) continue;
+                if (!formatted) {
+                    out.clear();
+                    layout.formatter->format(out, fields, cfg.includeThreadId);
+                    formatted = true;
+                }
+                callSink([&] {
+                    if (entry.fields) entry.sink->writeLine(record, out);
+                    else if (!bestEffort) entry.sink->write(rec.level, out);
+                    else if (!entry.sink->tryWrite(rec.level, out)) skipped = true;
+                    // The backend flushes once per pass instead (see endPass)
+                    if (cfg.autoFlush && !m_onBackend) entry.sink->flush();
+                });
+            }
         }
-        else {
-            oss << " ";
+        if (skipped) countDropped(rec.level);
+    }
+
+    // Async mode: returns once the backend wrote everything enqueued before the call
+    void waitForQueued() {
+        if (!m_async.load(std::memory_order_acquire) || m_onBackend) return;
+        Record marker;
+        marker.kind = Record::Kind::Flush;
+        marker.flushSeq = m_flushRequested.fetch_add(1, std::memory_order_relaxed) + 1;
+        const std::uint64_t seq = marker.flushSeq;
+        enqueue(std::move(marker), LogOverflowPolicy::Block);
+
+        std::unique_lock<std::mutex> wake(m_wakeMutex);
+        m_wakeCv.notify_one();
+        m_flushCv.wait(wake, [&] {
+            return m_flushCompleted >= seq || !m_async.load(std::memory_order_acquire);
+        });
+    }
+
+    void flushOutputs() {
+        ConfigReader reader(*this);
+        for (const SinkEntry& entry : reader.config().sinks) callSink([&] { entry.sink->flush(); });
+    }
+
+    // Every call into a sink runs as "in a sink", like the writes in writeRecord: a log made
+    // from inside it (e.g. by a handler callback) then only reaches the built-in sinks and
+    // cannot come back into the sink that is running
+    template <typename Call>
+    void callSink(Call&& call) noexcept {
+        const bool nested = std::exchange(m_inSink, true);
+        try { call(); }
+        catch (...) {}
+        m_inSink = nested;
+    }
+
+    // ---- async backend ----
+    void backendLoop() {
+        m_onBackend = true;
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        std::uint64_t ringsVersion = ~std::uint64_t{ 0 };
+        for (;;) {
+            const bool worked = drainQueues(rings, ringsVersion);
+            endPass(worked);
+            if (m_reclaimPending.load(std::memory_order_relaxed)) reclaimConfigs(/*wait=*/false);
+            if (worked) continue;
+            if (m_stopBackend.load(std::memory_order_acquire)) break;
+
+            // Producers never signal; poll the queues at a fixed interval while idle
+            std::unique_lock<std::mutex> wake(m_wakeMutex);
+            m_wakeCv.wait_for(wake, std::chrono::microseconds(LOGGY_ASYNC_IDLE_SLEEP_US));
         }
-        oss << msg;
-        return oss.str();
+        // Drain whatever was enqueued before the stop request became visible
+        while (drainQueues(rings, ringsVersion)) {}
+        m_onBackend = false;
     }
 
-    [[nodiscard]] constexpr const char* levelToStr(LogLevel level) const noexcept {
-        switch (level) {
-        case LogLevel::DEBUG: return "DEBUG";
-        case LogLevel::INFO:  return "INFO";
-        case LogLevel::WARN:  return "WARN";
-        case LogLevel::ERR:   return "ERROR";
-        case LogLevel::FATAL: return "FATAL";
-        default:              return "UNKNOWN";
+    // With auto flush, everything written during a pass goes out at its end (many lines per
+    // write call); otherwise sinks get their periodic poll().
+    void endPass(bool worked) {
+        ConfigReader reader(*this);
+        const Config& cfg = reader.config();
+        const auto now = std::chrono::steady_clock::now();
+        for (const SinkEntry& entry : cfg.sinks) {
+            callSink([&] {
+                if (worked && cfg.autoFlush) entry.sink->flush();
+                else entry.sink->poll(now);
+            });
         }
     }
 
-    // ---- console color helpers ----
-    void setConsoleColor(LogLevel level) {
-#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
-        HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
-        WORD color = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
-        switch (level) {
-        case LogLevel::DEBUG: color = FOREGROUND_BLUE | FOREGROUND_GREEN; break;           // cyan
-        case LogLevel::INFO:  color = FOREGROUND_GREEN; break;
-        case LogLevel::WARN:  color = FOREGROUND_RED | FOREGROUND_GREEN; break;            // yellow
-        case LogLevel::ERR:   color = FOREGROUND_RED; break;
-        case LogLevel::FATAL: color = FOREGROUND_RED | FOREGROUND_INTENSITY; break;
-        default: break;
+    // One pass over the shared queue and every thread ring; returns whether anything was processed.
+    // `rings` is the backend's private copy of m_rings, refreshed when a thread registered.
+    // While a flush waits or retired versions wait, the pass is a sweep: it writes at least
+    // every record queued before it started (rings past their batch bound), so waiting for
+    // it cannot starve behind a busy thread. A complete sweep finishes the flushes seen
+    // before it and publishes the epoch below which versions have no records left.
+    bool drainQueues(std::vector<std::shared_ptr<ThreadRing>>& rings, std::uint64_t& ringsVersion) {
+        constexpr int kRingBatch = 64;  // bound per ring so one busy thread cannot starve the others
+        const std::uint64_t flushSeen = m_flushSeen;
+        const bool trackEpoch = m_reclaimPending.load(std::memory_order_relaxed);
+        const bool sweep = trackEpoch || flushSeen > m_flushDone;
+        std::uint64_t passEpoch = 0;
+        if (trackEpoch) {
+            // Sections that ended before the scan queued their records before it; versions
+            // retired at or below passEpoch were only visible to such sections
+            passEpoch = loggy_detail::Epochs::current();
+            passEpoch = std::min(passEpoch, loggy_detail::Epochs::oldestActive());
         }
-        SetConsoleTextAttribute(h, color);
-#else
-        (void)level;
-#endif
+        const std::size_t queuedBefore = sweep ? m_queue->pushed() : 0;
+        bool complete = true;
+
+        bool worked = false;
+        Record rec;
+        while (m_queue->tryPop(rec)) {
+            worked = true;
+            processQueued(rec);
+        }
+        worked |= drainOverflow(m_overflow);
+        // A producer that claimed a cell but has not filled it yet ends the loop early
+        complete &= m_queue->popped() >= queuedBefore;
+
+        const std::uint64_t version = m_ringsVersion.load(std::memory_order_acquire);
+        if (version != ringsVersion) {
+            std::lock_guard<std::mutex> guard(m_ringsMutex);
+            rings = m_rings;
+            ringsVersion = version;
+        }
+        bool reap = false;
+        Record batch[kRingBatch];
+        for (auto& ring : rings) {
+            // While the spill list is active the ring only holds older records, so reaching the
+            // end of the ring covers both
+            const bool spilled = sweep && ring->overflow.active.load(std::memory_order_acquire);
+            const std::size_t target = sweep ? ring->ring.pushed() : 0;
+            bool emptied = false;
+            for (;;) {
+                int n = 0;
+                {
+                    // Pop under the consumer lock, process outside it (a DropOldest producer may pop too)
+                    std::lock_guard<std::mutex> guard(ring->consumerMutex);
+                    while (n < kRingBatch && ring->ring.tryPop(batch[n])) ++n;
+                }
+                for (int i = 0; i < n; ++i) processQueued(batch[i]);
+                worked |= n > 0;
+                emptied = n < kRingBatch;
+                if (emptied || !sweep || ring->ring.popped() >= target) break;
+            }
+            // A slow sink may have held up the batch long enough for the producer to refill the
+            // ring and spill; the spill stays behind that. Read `active` first: a spill seen
+            // active only holds records newer than anything still in the ring.
+            if (emptied && ring->overflow.active.load(std::memory_order_acquire)) {
+                emptied = ring->ring.empty();
+                if (emptied) worked |= drainOverflow(ring->overflow);
+            }
+            complete &= ring->ring.popped() >= target && (!spilled || emptied);
+            if (emptied && ring->abandoned.load(std::memory_order_acquire) && ring->ring.empty()
+                && !ring->overflow.active.load(std::memory_order_acquire)) reap = true;
+        }
+        if (reap) reapRings();
+        if (sweep && complete) {
+            if (trackEpoch && passEpoch > m_drainedEpoch.load(std::memory_order_relaxed))
+                m_drainedEpoch.store(passEpoch, std::memory_order_release);
+            if (flushSeen > m_flushDone) finishFlush(flushSeen);
+        }
+        reportDropsNow(/*force=*/false);
+        return worked;
     }
 
-    void resetConsoleColor() {
-#if defined(_WIN32) && LOGGY_COLORIZE_CONSOLE
-        HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
-        SetConsoleTextAttribute(h, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-#endif
+    // No backend running: whether nothing is left in any queue (late producers of a stopped backend)
+    [[nodiscard]] bool queuesEmpty() {
+        if (!m_queue) return true;
+        if (m_queue->pushed() != m_queue->popped() || m_overflow.active.load(std::memory_order_acquire)) return false;
+        std::lock_guard<std::mutex> guard(m_ringsMutex);
+        for (const auto& ring : m_rings)
+            if (!ring->ring.empty() || ring->overflow.active.load(std::memory_order_acquire)) return false;
+        return true;
     }
 
-    // ---- file helpers ----
-    static void ensureDir(const std::filesystem::path& fp) noexcept {
-        std::error_code ec;
-        const auto dir = fp.has_parent_path() ? fp.parent_path() : std::filesystem::current_path();
-        std::filesystem::create_directories(dir, ec);
-        // Ignore errors silently (best effort)
+    // Drops rings whose thread has exited once they are empty
+    void reapRings() {
+        std::lock_guard<std::mutex> guard(m_ringsMutex);
+        const auto before = m_rings.size();
+        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [](const std::shared_ptr<ThreadRing>& r) {
+            return r->abandoned.load(std::memory_order_acquire) && r->ring.empty()
+                && !r->overflow.active.load(std::memory_order_acquire);
+        }), m_rings.end());
+        if (m_rings.size() != before) m_ringsVersion.fetch_add(1, std::memory_order_release);
     }
 
-    void openLogFile(bool truncate) {
-        std::ios::openmode mode = std::ios::out;
-        if (!truncate) mode |= std::ios::app;
-        m_logFile.open(m_logFilePath, mode);
-        if (!m_logFile) {
-            std::cerr << "[Loggy] Failed to open log file: " << m_logFilePath << std::endl;
+    void processQueued(Record& rec) {
+        if (rec.kind == Record::Kind::Flush) {
+            // Other threads' records logged before the flush may still wait in their rings:
+            // the flush completes with the next complete sweep (see drainQueues). Markers of
+            // different rings arrive out of order; only a gapless run of them counts as seen.
+            if (rec.flushSeq != m_flushSeen + 1) {
+                m_flushAhead.push_back(rec.flushSeq);
+                return;
+            }
+            ++m_flushSeen;
+            for (;;) {
+                const auto next = std::find(m_flushAhead.begin(), m_flushAhead.end(), m_flushSeen + 1);
+                if (next == m_flushAhead.end()) break;
+                m_flushAhead.erase(next);
+                ++m_flushSeen;
+            }
+            return;
         }
-        m_lineCount = 0;
+        writeRecord(rec, *rec.config, /*bestEffort=*/false);
     }
 
-    void rotateIfNeeded() noexcept {
-        if (!m_fileOutput.load(std::memory_order_relaxed)) return;
-        std::error_code ec;
-        if (!std::filesystem::exists(m_logFilePath, ec)) return;
+    void finishFlush(std::uint64_t seq) {
+        flushOutputs();
+        m_flushDone = seq;
+        {
+            std::lock_guard<std::mutex> wake(m_wakeMutex);
+            if (seq > m_flushCompleted) m_flushCompleted = seq;
+        }
+        m_flushCv.notify_all();
+    }
 
-        auto sz = std::filesystem::file_size(m_logFilePath, ec);
-        if (ec || sz <= LOGGY_MAX_LOG_FILE_SIZE) return;
+    void stopBackend() noexcept {
+        std::lock_guard<std::mutex> guard(m_backendMutex);
+        stopBackendLocked();
+    }
 
-        m_logFile.flush();
-        m_logFile.close();
+    void stopBackendLocked() noexcept {
+        if (!m_backend.joinable()) return;
+        m_async.store(false, std::memory_order_release);
+        m_stopBackend.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> wake(m_wakeMutex);
+            m_wakeCv.notify_all();
+        }
+        m_backend.join();
 
-#if LOGGY_ROTATE_BACKUPS > 0
-        for (int i = LOGGY_ROTATE_BACKUPS - 1; i >= 1; --i) {
-            auto from = m_logFilePath;
-            from += "." + std::to_string(i);
-            auto to = m_logFilePath;
-            to += "." + std::to_string(i + 1);
-            if (std::filesystem::exists(from, ec)) {
-                std::filesystem::remove(to, ec);
-                std::filesystem::rename(from, to, ec);
-            }
+        // Late producers that saw async mode just before it was switched off
+        try {
+            std::vector<std::shared_ptr<ThreadRing>> rings;
+            std::uint64_t ringsVersion = ~std::uint64_t{ 0 };
+            while (drainQueues(rings, ringsVersion)) {}
+            reportDropsNow(/*force=*/true);
         }
-        auto first = m_logFilePath;
-        first += ".1";
-        std::filesystem::remove(first, ec);
-        std::filesystem::rename(m_logFilePath, first, ec);
-#endif
-        openLogFile(/*truncate=*/true);
+        catch (...) {}
+        m_backendActive.store(false, std::memory_order_release);
+        reclaimConfigs(/*wait=*/true);
+        std::lock_guard<std::mutex> wake(m_wakeMutex);
+        m_flushCv.notify_all();
+    }
+
+    // ---- formatting ----
+    [[nodiscard]] constexpr const char* levelToStr(LogLevel level) const noexcept {
+        return loggy_level_name(level);
     }
 };
 
@@ -412,9 +4308,18 @@ private:
 #ifndef LOGGY_DISABLE_LOGGING
     #define LOG(level, ...)   do { Logger::instance().log((level), __FUNCTION__, __VA_ARGS__); } while(0)
     #define LOG_EX(level, ...) do { Logger::instance().logEx((level), __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__); } while(0)
+    // `{}` format strings, parsed and checked against the argument count at compile time
+    #define LOGGY_LOGF_IMPL(level, file, line, fmt, ...) do { \
+            struct LoggyFormat_ { static constexpr std::string_view str() { return fmt; } }; \
+            Logger::instance().logf<LoggyFormat_>((level), __FUNCTION__, (file), (line) __VA_OPT__(,) __VA_ARGS__); \
+        } while(0)
+    #define LOGF(level, fmt, ...)    LOGGY_LOGF_IMPL(level, nullptr, 0, fmt __VA_OPT__(,) __VA_ARGS__)
+    #define LOGF_EX(level, fmt, ...) LOGGY_LOGF_IMPL(level, __FILE__, __LINE__, fmt __VA_OPT__(,) __VA_ARGS__)
 #else
     #define LOG(level, ...)    ((void)0)
     #define LOG_EX(level, ...) ((void)0)
+    #define LOGF(level, ...)    ((void)0)
+    #define LOGF_EX(level, ...) ((void)0)
 #endif
 
 // -----------------------------
@@ -422,14 +4327,19 @@ private:
 // -----------------------------
 class LogScopeTimer {
 public:
-    explicit LogScopeTimer(const char* what, LogLevel level = LogLevel::DEBUG) noexcept
+    // `what` is copied unless it has static storage (see LogSourceName)
+    explicit LogScopeTimer(LogSourceName what, LogLevel level = LogLevel::DEBUG)
         : m_what(what), m_level(level), m_start(std::chrono::steady_clock::now()) {
+        if (!m_what.isPersistent()) {
+            m_whatCopy = m_what.c_str();
+            m_what = LogSourceName(m_whatCopy.c_str());
+        }
     }
 
     ~LogScopeTimer() noexcept(false) {
         using namespace std::chrono;
         auto dur = duration_cast<microseconds>(steady_clock::now() - m_start).count();
-        Logger::instance().log(m_level, m_what, std::string("took "), dur, "us");
+        Logger::instance().log(m_level, m_what, "took ", dur, "us");
     }
 
     // Prevent copying
@@ -437,7 +4347,8 @@ public:
     LogScopeTimer& operator=(const LogScopeTimer&) = delete;
 
 private:
-    const char* m_what;
+    LogSourceName m_what;
+    std::string m_whatCopy;
     LogLevel m_level;
     std::chrono::steady_clock::time_point m_start;
 };
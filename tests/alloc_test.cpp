@@ -0,0 +1,97 @@
+// Steady-state logging must not allocate: counts every global operator new while a warmed-up
+// logger writes lines through two sinks with different layouts, in sync and in async mode.
+// One line has a loggy::lit() literal longer than the inline argument space, so the test
+// also fails if it is copied instead of kept by pointer.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocations{ 0 };
+std::atomic<bool> g_counting{ false };
+
+void* countedAlloc(std::size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// Formats every line (the logger skips layouts nobody is ready for) and throws it away
+class NullSink : public LogSink {
+public:
+    void write(LogLevel, std::string_view line) override { m_bytes += line.size(); }
+    std::uint64_t bytes() const noexcept { return m_bytes; }
+
+private:
+    std::uint64_t m_bytes = 0;
+};
+
+void logLines(Logger& logger, int count) {
+    const std::string user = "alice";
+    for (int i = 0; i < count; ++i) {
+        logger.log(LogLevel::INFO, "handler", "request ", i, " user=", user, " took ", 1.25 * i, "ms ok=", i % 2 == 0);
+        logger.logEx(LogLevel::WARN, "handler", "server.cpp", 42, "slow path ", static_cast<unsigned char>('a' + i % 26));
+        // Longer than LOGGY_INLINE_ARGS_SIZE: only fits into the record because lit() is kept by pointer
+        logger.log(LogLevel::DEBUG, "handler", loggy::lit("a marked literal is stored as a pointer, however long it is: "
+            "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"
+            "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"), i);
+    }
+}
+
+// Returns the allocations made by `count` warmed-up log calls (and their delivery)
+std::uint64_t measure(Logger& logger, int count) {
+    logLines(logger, count);    // warm-up: buffers and caches reach their working size
+    logger.flush();
+    g_allocations.store(0);
+    g_counting.store(true);
+    logLines(logger, count);
+    logger.flush();
+    g_counting.store(false);
+    return g_allocations.load();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+    int failures = 0;
+    auto expectNone = [&](const char* what, std::uint64_t allocations) {
+        std::printf("%-34s %llu allocations\n", what, static_cast<unsigned long long>(allocations));
+        if (allocations != 0) ++failures;
+    };
+
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    auto classic = std::make_shared<NullSink>();
+    auto custom = std::make_shared<NullSink>();
+    logger.addSink(classic);
+    logger.addSink(custom, LogLevel::DEBUG, "%H:%M:%S.%f %l [%t] %s:%# %! %v");
+
+    expectNone("sync, two layouts:", measure(logger, 20000));
+
+    logger.enableAsync(true);
+    expectNone("async shared queue, two layouts:", measure(logger, 20000));
+
+    logger.enableAsync(true, LogQueueMode::PerThread);
+    expectNone("async per-thread ring, two layouts:", measure(logger, 20000));
+    logger.shutdown();
+
+    if (classic->bytes() == 0 || custom->bytes() == 0) {
+        std::printf("sinks received no lines\n");
+        ++failures;
+    }
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
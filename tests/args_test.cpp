@@ -0,0 +1,116 @@
+// Deferred argument capture: every kind of argument prints as operator<< would print it, and
+// arguments and function / file names that may change or disappear after the log call are
+// copied (including a local const char array), in sync and async mode.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Point {
+    int x, y;
+};
+
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    return os << '(' << p.x << ',' << p.y << ')';
+}
+
+struct PairFormat {
+    static constexpr std::string_view str() { return "<{}|{}>"; }
+};
+
+std::mutex g_linesMutex;
+std::vector<std::string> g_lines;
+
+int g_failures = 0;
+
+// Logs a const char array that ends with the call
+[[gnu::noinline]] void logLocalArray(Logger& logger) {
+    const char local[] = "local array";
+    logger.log(LogLevel::INFO, "test", local);
+}
+
+// Reuses the stack the array of logLocalArray lived on
+[[gnu::noinline]] void clobberStack() {
+    volatile char junk[256];
+    for (auto& c : junk) c = '#';
+}
+
+void expectLine(std::size_t index, const std::string& message) {
+    std::lock_guard<std::mutex> lock(g_linesMutex);
+    const std::string line = index < g_lines.size() ? g_lines[index] : std::string("<missing>");
+    const bool ok = line.size() >= message.size() && line.compare(line.size() - message.size(), message.size(), message) == 0;
+    if (!ok) {
+        std::printf("line %zu: expected \"...%s\", got \"%s\"\n", index, message.c_str(), line.c_str());
+        ++g_failures;
+    }
+}
+
+void run(Logger& logger, const char* mode) {
+    {
+        std::lock_guard<std::mutex> lock(g_linesMutex);
+        g_lines.clear();
+    }
+    char buffer[16] = "before";
+    std::string text = "str";
+    const char* pointer = text.c_str();
+    const int number = -7;
+    logger.log(LogLevel::INFO, "test", "literal ", buffer, ' ', pointer, ' ', std::string_view(text), ' ', number, ' ', 2.5, ' ', true);
+    logger.log(LogLevel::INFO, "test", std::string("temporary"), ' ', Point{ 1, 2 }, ' ', 42u);
+    logger.logf<PairFormat>(LogLevel::INFO, "test", nullptr, 0, buffer, number);
+    // A function name that is not static is copied, like any other argument
+    std::string name = "worker-7";
+    logger.log(LogLevel::INFO, name.c_str(), "named");
+    logger.logEx(LogLevel::INFO, "test", name.c_str(), 12, "from file");
+    logLocalArray(logger);
+    logger.log(LogLevel::INFO, "test", loggy::lit("marked "), "literal");
+    // The buffer and the string change before an async backend gets to the records
+    std::strcpy(buffer, "after");
+    text = "changed";
+    name.assign(64, '#');
+    clobberStack();
+    logger.flush();
+
+    std::printf("%s\n", mode);
+    expectLine(0, "literal before str str -7 2.5 1");
+    expectLine(1, "temporary (1,2) 42");
+    expectLine(2, "<before|-7>");
+    expectLine(3, "worker-7 -> named");
+    expectLine(4, "[worker-7:12] test -> from file");
+    expectLine(5, "local array");
+    expectLine(6, "marked literal");
+}
+
+} // namespace
+
+static_assert(LogSourceName(__FILE__).isPersistent(), "__FILE__ is kept by pointer");
+static_assert(LogSourceName::persistent("x").isPersistent());
+
+int main() {
+    char mutableName[] = "buffer";
+    const char* pointerName = "pointer";
+    if (LogSourceName(mutableName).isPersistent() || LogSourceName(pointerName).isPersistent()) {
+        std::printf("a char buffer or pointer was taken for a static name\n");
+        ++g_failures;
+    }
+
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    logger.setCustomLogHandler([](const std::string& line) {
+        std::lock_guard<std::mutex> lock(g_linesMutex);
+        g_lines.push_back(line);
+    });
+
+    run(logger, "sync");
+    logger.enableAsync(true);
+    run(logger, "async");
+    logger.shutdown();
+
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
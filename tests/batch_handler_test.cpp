@@ -0,0 +1,113 @@
+// A batch handler sees the fields of each line, not only the formatted text; lines still
+// pending when the handler is replaced or destroyed are delivered, including lines that other
+// threads queued into their own rings (LogQueueMode::PerThread) before the switch.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void check(const char* what, bool ok) {
+    std::printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++g_failures;
+}
+
+void fields(bool async) {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    std::vector<LogRecordView> seen;
+    std::vector<std::string> text;      // copies of the views, which end with the callback
+    logger.setBatchLogHandler([&](std::span<const LogRecordView> lines) {
+        for (const LogRecordView& v : lines) {
+            seen.push_back(v);
+            text.emplace_back(v.line);
+            text.emplace_back(v.threadName);
+            text.emplace_back(v.file);
+            text.emplace_back(v.function);
+            text.emplace_back(v.message);
+        }
+    });
+    if (async) logger.enableAsync(true);
+    Logger::setThreadName("main");
+
+    const auto before = std::chrono::system_clock::now();
+    logger.logEx(LogLevel::WARN, "handle", "server.cpp", 42, "request ", 7, " failed");
+    logger.flush();
+    const auto after = std::chrono::system_clock::now();
+    Logger::setThreadName({});
+
+    const char* what = async ? "async fields" : "sync fields";
+    if (seen.size() != 1) {
+        std::printf("%s: %zu lines, expected 1\n", what, seen.size());
+        ++g_failures;
+        return;
+    }
+    const LogRecordView& v = seen[0];
+    check(what, v.level == LogLevel::WARN && v.time >= before && v.time <= after && v.threadId != 0
+        && v.sourceLine == 42 && text[0].find("request 7 failed") != std::string::npos
+        && text[1] == "main" && text[2].ends_with("server.cpp") && text[3] == "handle"
+        && text[4] == "request 7 failed");
+}
+
+// Threads keep logging while the handler is switched; every line goes to exactly one of the
+// two handlers. Log calls that were running during the switch may still reach the old one: it
+// delivers their lines when it is released.
+void perThreadSwitch() {
+    constexpr int kThreads = 4;
+    constexpr int kLines = 20000;
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    std::atomic<long> first{ 0 }, second{ 0 };
+    logger.setBatchLogHandler([&](std::span<const LogRecordView> lines) {
+        first += static_cast<long>(lines.size());
+    });
+    logger.enableAsync(true, LogQueueMode::PerThread);
+
+    std::atomic<int> running{ kThreads };
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < kLines; ++i) logger.log(LogLevel::INFO, "writer", t, " ", i);
+            --running;
+        });
+    }
+    while (first.load() == 0 && running.load() > 0) std::this_thread::yield();
+    logger.setBatchLogHandler([&](std::span<const LogRecordView> lines) { second += static_cast<long>(lines.size()); });
+    for (auto& w : writers) w.join();
+    logger.flush();
+    logger.shutdown();
+
+    const long total = first.load() + second.load();
+    if (total != static_cast<long>(kThreads) * kLines) std::printf("%ld + %ld lines delivered, expected %d\n", first.load(), second.load(), kThreads * kLines);
+    check("per-thread rings, handler switch", total == static_cast<long>(kThreads) * kLines);
+}
+
+void destructorFlush() {
+    std::size_t delivered = 0;
+    {
+        LogBatchCallbackSink sink([&](std::span<const LogRecordView> lines) { delivered += lines.size(); }, 100);
+        for (int i = 0; i < 3; ++i) sink.write(LogLevel::INFO, "pending");
+    }
+    check("pending lines delivered on destruction", delivered == 3);
+}
+
+} // namespace
+
+int main() {
+    fields(false);
+    fields(true);
+    perThreadSwitch();
+    destructorFlush();
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+// Compressed backups: after size rotation and after time rotation, each file that left the
+// active position is replaced by its compressed copy on the maintenance thread, and unpacking
+// the chain gives back exactly the lines written. LZ4 frames are unpacked by a decoder written
+// from the format description, independent of the library's compressor; built with
+// -DLOGGY_COMPRESS_WITH_ZLIB=1 the backups are gzip and zlib unpacks them.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void fail(const char* what, const std::string& detail) {
+    std::printf("%s: %s\n", what, detail.c_str());
+    ++g_failures;
+}
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+#if LOGGY_COMPRESS_WITH_ZLIB
+std::optional<std::string> unpack(const std::string& packed) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) return std::nullopt;
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(packed.data()));
+    zs.avail_in = static_cast<uInt>(packed.size());
+    std::string out;
+    char buf[64 * 1024];
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        zs.next_out = reinterpret_cast<Bytef*>(buf);
+        zs.avail_out = sizeof(buf);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        out.append(buf, sizeof(buf) - zs.avail_out);
+    }
+    const bool complete = rc == Z_STREAM_END && zs.avail_in == 0;
+    inflateEnd(&zs);
+    if (!complete) return std::nullopt;
+    return out;
+}
+#else
+std::uint32_t read32(const std::string& s, std::size_t at) {
+    std::uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | static_cast<std::uint8_t>(s[at + static_cast<std::size_t>(i)]);
+    return v;
+}
+
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+bool unpackBlock(const std::string& s, std::size_t pos, std::size_t end, std::string& out) {
+    const auto length = [&](std::size_t value) -> std::optional<std::size_t> {
+        if (value != 15) return value;
+        for (;;) {
+            if (pos >= end) return std::nullopt;
+            const std::uint8_t b = static_cast<std::uint8_t>(s[pos++]);
+            value += b;
+            if (b != 255) return value;
+        }
+    };
+    while (pos < end) {
+        const std::uint8_t token = static_cast<std::uint8_t>(s[pos++]);
+        const auto literals = length(token >> 4);
+        if (!literals || pos + *literals > end) return false;
+        out.append(s, pos, *literals);
+        pos += *literals;
+        if (pos == end) return true;            // the last sequence has no match
+        if (pos + 2 > end) return false;
+        const std::size_t offset = static_cast<std::uint8_t>(s[pos]) | static_cast<std::size_t>(static_cast<std::uint8_t>(s[pos + 1])) << 8;
+        pos += 2;
+        const auto match = length(token & 15);
+        if (!match || offset == 0 || offset > out.size()) return false;
+        const std::size_t from = out.size() - offset;
+        for (std::size_t i = 0; i < *match + 4; ++i) out.push_back(out[from + i]);   // may overlap
+    }
+    return false;
+}
+
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md
+std::optional<std::string> unpack(const std::string& s) {
+    if (s.size() < 7 || read32(s, 0) != 0x184D2204) return std::nullopt;
+    const std::uint8_t flags = static_cast<std::uint8_t>(s[4]);
+    if ((flags >> 6) != 1 || (flags & 1)) return std::nullopt;     // version 01, no dictionary
+    const bool blockChecksum = flags & 0x10, contentSize = flags & 0x08, contentChecksum = flags & 0x04;
+    std::size_t pos = 6 + (contentSize ? 8 : 0) + 1;    // FLG, BD, content size, header checksum
+    std::string out;
+    for (;;) {
+        if (pos + 4 > s.size()) return std::nullopt;
+        const std::uint32_t header = read32(s, pos);
+        pos += 4;
+        if (header == 0) break;
+        const std::size_t size = header & 0x7FFFFFFFu;
+        if (pos + size > s.size()) return std::nullopt;
+        if (header & 0x80000000u) out.append(s, pos, size);
+        else if (!unpackBlock(s, pos, pos + size, out)) return std::nullopt;
+        pos += size + (blockChecksum ? 4 : 0);
+    }
+    if (pos + (contentChecksum ? 4 : 0) != s.size()) return std::nullopt;
+    return out;
+}
+#endif
+
+// Text of a finished file: unpacked if it carries the compressed extension
+std::optional<std::string> content(const std::filesystem::path& path) {
+    const std::string name = path.filename().string();
+    const std::string extension = loggy_detail::kCompressedExtension;
+    if (name.size() > extension.size() && name.ends_with(extension)) return unpack(readFile(path));
+    return readFile(path);
+}
+
+// Lines of repeated text (compressible) and of random printable characters (stored blocks)
+std::string line(std::mt19937& random, int i) {
+    std::string text = "line " + std::to_string(i) + " ";
+    if (i % 50 < 25) {
+        for (int k = 0; k < 8; ++k) text += "request handled in 12 ms; ";
+    }
+    else {
+        std::uniform_int_distribution<int> printable(' ', '~');
+        for (int k = 0; k < 200; ++k) text.push_back(static_cast<char>(printable(random)));
+    }
+    return text;
+}
+
+void sizeRotation() {
+    const char* what = "size backups";
+    const int failuresBefore = g_failures;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_compression_test";
+    std::filesystem::remove_all(dir);
+    const std::filesystem::path path = dir / "app.log";
+
+    // Files of 150 KB: more than two 64 KB blocks each
+    std::string written;
+    {
+        LogFileSink sink;
+        LogRotationPolicy policy;
+        policy.maxFileSize = 150 * 1024;
+        policy.maxBackups = 100;
+        sink.setRotationPolicy(policy);
+        sink.setCompression(true);
+        sink.open(path);
+        std::mt19937 random(1);
+        for (int i = 0; i < 3000; ++i) {
+            const std::string text = line(random, i);
+            sink.write(LogLevel::INFO, text);
+            written += text + "\n";
+        }
+        sink.close();   // waits for the maintenance thread
+    }
+
+    // app.log.N ... app.log.1 are compressed, app.log is not; nothing else is left
+    const auto backup = [&](int index) { return dir / ("app.log." + std::to_string(index) + loggy_detail::kCompressedExtension); };
+    int backups = 0;
+    while (std::filesystem::exists(backup(backups + 1))) ++backups;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const std::string name = entry.path().filename().string();
+        int index = 0;
+        for (index = 1; index <= backups && entry.path() != backup(index); ++index) {}
+        if (name != "app.log" && index > backups) fail(what, "unexpected file " + name);
+    }
+    if (backups < 3) fail(what, std::to_string(backups) + " backups");
+
+    std::string unpacked;
+    for (int index = backups; index >= 1; --index) {
+        const auto file = backup(index);
+        const auto text = content(file);
+        if (!text) fail(what, file.filename().string() + " does not unpack");
+        else unpacked += *text;
+    }
+    unpacked += readFile(path);
+    if (unpacked != written) fail(what, "unpacked chain differs from the lines written");
+
+    std::filesystem::remove_all(dir);
+    std::printf("%s: %s\n", what, g_failures == failuresBefore ? "ok" : "FAILED");
+}
+
+void timeRotation() {
+    const char* what = "past periods";
+    const int failuresBefore = g_failures;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_compression_test";
+    std::filesystem::remove_all(dir);
+
+    // Lines over 2.5 one-second periods: two or three past periods, each compressed
+    std::string written;
+    int count = 0;
+    {
+        LogFileSink sink;
+        sink.setTimeRotation(std::chrono::seconds(1));
+        sink.setCompression(true);
+        sink.open(dir / "app-%H%M%S.log");
+        std::mt19937 random(2);
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2500);
+        while (std::chrono::steady_clock::now() < end) {
+            const std::string text = line(random, count++);
+            sink.write(LogLevel::INFO, text);
+            written += text + "\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        sink.close();
+    }
+
+    // Ordered by their first line (names wrap at midnight); only the last file is plain
+    std::vector<std::pair<int, std::string>> files;
+    int plain = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const std::string name = entry.path().filename().string();
+        if (!name.ends_with(loggy_detail::kCompressedExtension)) ++plain;
+        const auto text = content(entry.path());
+        if (!text) {
+            fail(what, name + " does not unpack");
+            continue;
+        }
+        int first = -1;
+        std::sscanf(text->c_str(), "line %d", &first);
+        files.emplace_back(first, *text);
+    }
+    std::sort(files.begin(), files.end());
+    std::string unpacked;
+    for (const auto& file : files) unpacked += file.second;
+    if (files.size() < 3) fail(what, std::to_string(files.size()) + " files in 2.5 seconds");
+    if (plain != 1) fail(what, std::to_string(plain) + " uncompressed files");
+    if (unpacked != written) fail(what, "unpacked files differ from the lines written");
+
+    std::filesystem::remove_all(dir);
+    std::printf("%s: %s\n", what, g_failures == failuresBefore ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    std::printf("format: %s\n", loggy_detail::kCompressedExtension);
+    sizeRotation();
+    timeRotation();
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+// Replaced configuration versions are freed, so removed sinks are destroyed: right away when
+// nobody logs, only after a log call that may still use the old version has finished, and in
+// async mode once the records queued with it were written. Also churns sinks while threads log.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<int> g_destroyed{ 0 };
+
+class CountingSink : public LogSink {
+public:
+    explicit CountingSink(std::atomic<int>* destroyedFlag = nullptr) : m_destroyedFlag(destroyedFlag) {}
+    ~CountingSink() override {
+        g_destroyed.fetch_add(1);
+        if (m_destroyedFlag) m_destroyedFlag->store(1);
+    }
+    void write(LogLevel, std::string_view) override { m_lines.fetch_add(1); }
+    int lines() const noexcept { return m_lines.load(); }
+
+private:
+    std::atomic<int>* m_destroyedFlag;
+    std::atomic<int> m_lines{ 0 };
+};
+
+// Holds the first write() until released, so a log call stays inside its section
+class GateSink : public LogSink {
+public:
+    void write(LogLevel, std::string_view) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_entered = true;
+        m_cv.notify_all();
+        m_cv.wait(lock, [&] { return m_open; });
+    }
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_entered; });
+    }
+    void open() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = true;
+        m_cv.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_entered = false;
+    bool m_open = false;
+};
+
+bool waitFor(const std::atomic<int>& value, int expected) {
+    for (int i = 0; i < 2000 && value.load() != expected; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return value.load() == expected;
+}
+
+Logger& quietLogger(Logger& logger) {
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    return logger;
+}
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    std::printf("%-58s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++failures;
+}
+
+void removedSinkIsDestroyed(bool async) {
+    Logger logger;
+    quietLogger(logger);
+    if (async) logger.enableAsync(true);
+    std::atomic<int> destroyed{ 0 };
+    auto sink = std::make_shared<CountingSink>(&destroyed);
+    logger.addSink(sink);
+    for (int i = 0; i < 100; ++i) logger.log(LogLevel::INFO, "test", "line ", i);
+    logger.removeSink(sink);
+    const int lines = sink->lines();
+    sink.reset();
+    expect(lines == 100, async ? "async: removed sink got every line" : "sync: removed sink got every line");
+    expect(async ? waitFor(destroyed, 1) : destroyed.load() == 1,
+        async ? "async: removed sink destroyed" : "sync: removed sink destroyed on removeSink");
+    logger.shutdown();
+}
+
+// A log call that loaded the old version still writes to the removed sink; the sink is
+// destroyed only after that call ended
+void readerKeepsVersion() {
+    Logger logger;
+    quietLogger(logger);
+    auto gate = std::make_shared<GateSink>();
+    std::atomic<int> destroyed{ 0 };
+    auto removed = std::make_shared<CountingSink>(&destroyed);
+    logger.addSink(gate);
+    logger.addSink(removed);
+
+    std::thread writer([&] { logger.log(LogLevel::INFO, "test", "held in the gate"); });
+    gate->waitEntered();
+    logger.removeSink(removed);
+    removed.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    expect(destroyed.load() == 0, "sync: sink kept while a log call may use it");
+    gate->open();
+    writer.join();
+    expect(destroyed.load() == 1, "sync: sink destroyed when that call ended");
+    logger.removeSink(gate);
+}
+
+// Sinks added and removed while other threads log: every one of them is destroyed
+void churn(bool async, LogQueueMode mode = LogQueueMode::PerThread) {
+    constexpr int kSinks = 2000;
+    Logger logger;
+    quietLogger(logger);
+    if (async) logger.enableAsync(true, mode);
+    g_destroyed.store(0);
+
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            int i = 0;
+            while (!stop.load()) logger.log(LogLevel::INFO, "churn", "line ", i++);
+        });
+    }
+    for (int i = 0; i < kSinks; ++i) {
+        auto sink = std::make_shared<CountingSink>();
+        logger.addSink(sink, LogLevel::DEBUG, i % 2 ? "%v" : "");
+        logger.setLogLevel(i % 3 ? LogLevel::DEBUG : LogLevel::INFO);
+        logger.removeSink(sink);
+    }
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    logger.flush();
+    const char* what = !async ? "sync: every churned sink destroyed"
+        : mode == LogQueueMode::Shared ? "async shared queue: every churned sink destroyed"
+        : "async per-thread rings: every churned sink destroyed";
+    expect(waitFor(g_destroyed, kSinks), what);
+    logger.shutdown();
+}
+
+} // namespace
+
+int main() {
+    removedSinkIsDestroyed(false);
+    removedSinkIsDestroyed(true);
+    readerKeepsVersion();
+    churn(false);
+    churn(true, LogQueueMode::Shared);
+    churn(true, LogQueueMode::PerThread);
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
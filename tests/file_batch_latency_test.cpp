@@ -0,0 +1,71 @@
+// The file sink's batch age limit (LOGGY_FILE_BATCH_LATENCY_US) holds without further lines
+// and without poll(): in synchronous mode a line followed by a pause reaches the file on its
+// own, written by the timer on the sink's maintenance thread.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace {
+
+int g_failures = 0;
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+// Waits up to a second for `expected`; the limit is 1 ms, the rest is scheduling slack
+bool arrives(const std::filesystem::path& path, const std::string& expected) {
+    for (int i = 0; i < 100; ++i) {
+        if (readFile(path) == expected) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+void check(const char* what, bool ok) {
+    std::printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++g_failures;
+}
+
+void sinkAlone(LogFileBackend backend, const char* what) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "loggy_batch_latency_test.log";
+    LogFileSink sink(path, backend);
+    sink.write(LogLevel::INFO, "first");
+    const bool first = arrives(path, "first\n");
+    sink.write(LogLevel::INFO, "second");
+    sink.write(LogLevel::INFO, "third");
+    const bool more = arrives(path, "first\nsecond\nthird\n");
+    check(what, first && more);
+    sink.close();
+    std::filesystem::remove(path);
+}
+
+void syncLogger() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "loggy_batch_latency_logger.log";
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.setPattern("%v");
+    logger.setLogPath(path);
+    logger.log(LogLevel::INFO, "test", "line before a pause");
+    check("sync logger", arrives(path, "line before a pause\n"));
+    logger.shutdown();
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main() {
+    sinkAlone(LogFileBackend::Stream, "stream backend");
+    sinkAlone(LogFileBackend::Posix, "posix backend");
+    syncLogger();
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
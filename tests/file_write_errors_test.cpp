@@ -0,0 +1,57 @@
+// Bytes the OS refuses are counted in LogFileStats::lostBytes. A file size limit
+// (RLIMIT_FSIZE) makes writes past it fail with EFBIG: in the io_uring backend the failed
+// completion is retried with pwrite(), which fails as well, so the rest is counted as lost
+// instead of silently vanishing with the completion.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include <sys/resource.h>
+
+namespace {
+
+int g_failures = 0;
+
+void run(LogFileBackend backend, const char* name) {
+    constexpr std::uint64_t kLimit = 2500;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "loggy_write_errors_test.log";
+    std::filesystem::remove(path);
+    const std::string line(999, 'x');
+
+    LogFileSink sink(backend);
+    sink.setBufferSize(0);      // one write per line
+    sink.open(path);
+
+    rlimit old{};
+    ::getrlimit(RLIMIT_FSIZE, &old);
+    rlimit limited = old;
+    limited.rlim_cur = kLimit;
+    ::setrlimit(RLIMIT_FSIZE, &limited);
+    for (int i = 0; i < 4; ++i) sink.write(LogLevel::INFO, line);
+    sink.flush();
+    const LogFileStats stats = sink.stats();
+    sink.close();
+    ::setrlimit(RLIMIT_FSIZE, &old);
+
+    const std::uint64_t size = std::filesystem::file_size(path);
+    std::filesystem::remove(path);
+    const bool ok = stats.bytes == 4000 && size == kLimit && stats.lostBytes == stats.bytes - size;
+    std::printf("%s: %llu bytes written, %llu in the file, %llu counted as lost: %s\n", name,
+        static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long long>(size),
+        static_cast<unsigned long long>(stats.lostBytes), ok ? "ok" : "FAILED");
+    if (!ok) ++g_failures;
+}
+
+} // namespace
+
+int main() {
+    std::signal(SIGXFSZ, SIG_IGN);  // EFBIG instead of the signal
+    run(LogFileBackend::Posix, "posix");
+    run(LogFileBackend::Uring, "uring");
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+// A batch handler that logs or flushes from inside its callback must not deadlock, whether the
+// callback runs from a write, Logger::flush(), the backend's poll() or a handler switch.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <future>
+
+namespace {
+
+int g_failures = 0;
+
+// Runs `body` on its own thread and fails the test if it does not finish in time
+template <typename Body>
+void expectFinishes(const char* what, Body body) {
+    auto done = std::async(std::launch::async, body);
+    if (done.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        std::printf("%s: deadlock\n", what);
+        std::fflush(stdout);
+        std::_Exit(1);   // the hung thread cannot be joined
+    }
+    std::printf("%s: ok\n", what);
+}
+
+void run(bool async, const char* mode) {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.enableFileOutput(false);
+    std::atomic<std::size_t> delivered{ 0 };
+    logger.setBatchLogHandler([&](std::span<const LogRecordView> lines) {
+        for (const LogRecordView& line : lines) {
+            if (line.line.find("handler saw") == std::string_view::npos) ++delivered;
+        }
+        logger.log(LogLevel::INFO, "handler", "handler saw ", lines.size(), " lines");
+        logger.flush();
+    }, 8);
+    if (async) logger.enableAsync(true);
+
+    char what[64];
+    std::snprintf(what, sizeof(what), "%s, full batches", mode);
+    expectFinishes(what, [&] {
+        for (int i = 0; i < 100; ++i) logger.log(LogLevel::INFO, "test", "line ", i);
+        logger.flush();
+    });
+    std::snprintf(what, sizeof(what), "%s, flush and poll", mode);
+    expectFinishes(what, [&] {
+        logger.log(LogLevel::INFO, "test", "single line");
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));   // past the batch latency: poll() delivers
+        logger.flush();
+    });
+    std::snprintf(what, sizeof(what), "%s, handler switch", mode);
+    expectFinishes(what, [&] {
+        logger.log(LogLevel::INFO, "test", "pending line");
+        logger.setBatchLogHandler([](std::span<const LogRecordView>) {});
+        logger.shutdown();
+    });
+    if (delivered.load() != 102) {
+        std::printf("%s: %zu lines delivered, expected 102\n", mode, delivered.load());
+        ++g_failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    run(false, "sync");
+    run(true, "async");
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+// LogFileBackend::Mmap preallocates the file in chunks and only cuts it to its real length on
+// close. A process that dies before that leaves NUL padding after the last line; appending to
+// such a file (here: the current period's file with daily rotation) must continue right after
+// the last line instead of after the padding.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+int g_failures = 0;
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+void run(const char* what, const std::string& leftOver, const std::string& expected) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_mmap_append_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    // The file of the current period, as a crashed run left it
+    char name[64];
+    const std::tm now = loggy_detail::localTime(std::time(nullptr));
+    std::strftime(name, sizeof(name), "app-%Y%m%d.log", &now);
+    const std::filesystem::path path = dir / name;
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << leftOver << std::string(1 << 20, '\0');
+    }
+
+    {
+        LogFileSink sink(LogFileBackend::Mmap);
+        sink.setTimeRotation(LogRotateInterval::Daily);
+        sink.open(dir / "app-%Y%m%d.log");
+        sink.write(LogLevel::INFO, "line 3");
+        sink.close();
+    }
+
+    const std::string content = readFile(path);
+    const bool ok = content == expected;
+    std::printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) {
+        std::printf("  %zu bytes, expected %zu\n", content.size(), expected.size());
+        ++g_failures;
+    }
+    std::filesystem::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+    run("appends after the last line of a padded file", "line 1\nline 2\n", "line 1\nline 2\nline 3\n");
+    run("padding only", "", "line 3\n");
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
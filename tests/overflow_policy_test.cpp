@@ -0,0 +1,167 @@
+// Overflow policies of a full async queue. A sink that blocks on its first line stalls the
+// backend; 200 lines (DEBUG, then INFO) are logged into the small queue behind it, then the
+// sink is released. Block delivers everything after waiting, DropNewest keeps the first lines,
+// DropOldest the last ones, Grow everything without waiting or, with a small memory cap, more
+// than DropNewest but not all. Each lost line is counted at its level, and the "N messages
+// dropped" lines in the log add up to the same counts. Shared queue and per-thread rings.
+// Build and run: see tests/README.md
+#define LOGGY_ASYNC_QUEUE_SIZE 64
+#define LOGGY_THREAD_QUEUE_SIZE 64
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+constexpr int kLines = 200;     // lines 0..99 DEBUG, 100..199 INFO
+
+void fail(const std::string& what, const std::string& detail) {
+    std::printf("%s: %s\n", what.c_str(), detail.c_str());
+    ++g_failures;
+}
+
+// Collects lines; the first write waits until release()
+class GateSink : public LogSink {
+public:
+    void write(LogLevel, std::string_view line) override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_lines.emplace_back(line);
+        if (m_open) return;
+        m_entered = true;
+        m_cv.notify_all();
+        m_cv.wait(lock, [this] { return m_open; });
+    }
+
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_entered; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_open = true;
+        m_cv.notify_all();
+    }
+
+    std::vector<std::string> lines() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lines;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_entered = false;
+    bool m_open = false;
+    std::vector<std::string> m_lines;
+};
+
+enum class Shape { All, Prefix, Suffix };
+
+// Runs one policy; returns the number of lines delivered
+int run(const std::string& what, LogQueueMode mode, LogOverflowPolicy policy, std::size_t growLimit, Shape shape, bool waits) {
+    const int failuresBefore = g_failures;
+    auto sink = std::make_shared<GateSink>();
+    std::uint64_t dropped[2] = {};
+    std::atomic<bool> released{ false };
+    bool waited = false;
+    {
+        Logger logger;
+        logger.enableConsoleOutput(false);
+        logger.setPattern("%v");
+        logger.setLogLevel(LogLevel::DEBUG);
+        logger.addSink(sink, LogLevel::DEBUG);
+        logger.setOverflowPolicy(policy, growLimit);
+        logger.enableAsync(true, mode);
+
+        logger.log(LogLevel::INFO, "test", "stall");
+        sink->waitEntered();
+        std::thread releaser([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            released = true;
+            sink->release();
+        });
+        for (int i = 0; i < kLines; ++i) logger.log(i < kLines / 2 ? LogLevel::DEBUG : LogLevel::INFO, "test", "line ", i);
+        waited = released.load();
+        releaser.join();
+        logger.flush();
+        logger.shutdown();      // writes the last drop report
+        dropped[0] = logger.droppedMessages(LogLevel::DEBUG);
+        dropped[1] = logger.droppedMessages(LogLevel::INFO);
+        if (logger.droppedMessages() != dropped[0] + dropped[1]) fail(what, "drops counted at other levels");
+    }
+    if (waited != waits) fail(what, waits ? "did not wait for the backend" : "waited for the backend");
+
+    // Delivered lines in order, and the drop reports summed per level
+    std::vector<int> delivered;
+    std::uint64_t reported = 0, reportedLevel[2] = {};
+    for (const std::string& text : sink->lines()) {
+        int i = -1;
+        unsigned long long count = 0;
+        if (std::sscanf(text.c_str(), "line %d", &i) == 1) delivered.push_back(i);
+        else if (std::sscanf(text.c_str(), "%llu messages dropped", &count) == 1) {
+            reported += count;
+            const char* names[2] = { "DEBUG: ", "INFO: " };
+            for (int level = 0; level < 2; ++level) {
+                const auto at = text.find(names[level]);
+                if (at != std::string::npos) reportedLevel[level] += std::stoull(text.substr(at + std::strlen(names[level])));
+            }
+        }
+        else if (text != "stall") fail(what, "unexpected line \"" + text + "\"");
+    }
+
+    const int count = static_cast<int>(delivered.size());
+    const int first = shape == Shape::Suffix ? kLines - count : 0;
+    for (int k = 0; k < count; ++k) {
+        if (delivered[k] != first + k) {
+            fail(what, "line " + std::to_string(delivered[k]) + " at position " + std::to_string(k) + ", expected " + std::to_string(first + k));
+            break;
+        }
+    }
+    if (shape == Shape::All && count != kLines) fail(what, std::to_string(count) + " lines delivered");
+    if (shape != Shape::All && (count < 16 || count >= kLines)) fail(what, std::to_string(count) + " lines delivered");
+
+    // The lost lines are exactly the ones not delivered, at their levels
+    std::uint64_t expected[2] = {};
+    for (int i = 0; i < kLines; ++i) {
+        if (i < first || i >= first + count) ++expected[i < kLines / 2 ? 0 : 1];
+    }
+    if (dropped[0] != expected[0] || dropped[1] != expected[1])
+        fail(what, "dropped DEBUG " + std::to_string(dropped[0]) + ", INFO " + std::to_string(dropped[1]) +
+            "; expected " + std::to_string(expected[0]) + ", " + std::to_string(expected[1]));
+    if (reported != dropped[0] + dropped[1] || reportedLevel[0] != dropped[0] || reportedLevel[1] != dropped[1])
+        fail(what, "\"messages dropped\" lines report " + std::to_string(reported) + " (DEBUG " + std::to_string(reportedLevel[0]) +
+            ", INFO " + std::to_string(reportedLevel[1]) + ")");
+
+    std::printf("%s: %d lines delivered, %s\n", what.c_str(), count, g_failures == failuresBefore ? "ok" : "FAILED");
+    return count;
+}
+
+void runAll(LogQueueMode mode, const char* name) {
+    const std::string prefix = std::string(name) + " ";
+    run(prefix + "Block", mode, LogOverflowPolicy::Block, LOGGY_OVERFLOW_GROW_LIMIT, Shape::All, true);
+    const int newest = run(prefix + "DropNewest", mode, LogOverflowPolicy::DropNewest, LOGGY_OVERFLOW_GROW_LIMIT, Shape::Prefix, false);
+    run(prefix + "DropOldest", mode, LogOverflowPolicy::DropOldest, LOGGY_OVERFLOW_GROW_LIMIT, Shape::Suffix, false);
+    run(prefix + "Grow", mode, LogOverflowPolicy::Grow, LOGGY_OVERFLOW_GROW_LIMIT, Shape::All, false);
+    const int capped = run(prefix + "Grow with a 4 KB cap", mode, LogOverflowPolicy::Grow, 4096, Shape::Prefix, false);
+    if (capped <= newest) fail(prefix + "Grow with a 4 KB cap", "spilled nothing beyond the queue");
+}
+
+} // namespace
+
+int main() {
+    runAll(LogQueueMode::Shared, "shared queue:");
+    runAll(LogQueueMode::PerThread, "per-thread rings:");
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
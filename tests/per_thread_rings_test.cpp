@@ -0,0 +1,88 @@
+// LogQueueMode::PerThread with threads that alternate between two loggers: each (thread,
+// logger) pair keeps one ring, so every thread's lines reach each logger in order and no ring
+// is registered again on a switch.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Checks that the sequence numbers of every writer thread arrive in increasing order
+class OrderSink : public LogSink {
+public:
+    explicit OrderSink(int writers) : m_next(writers, 0) {}
+
+    void write(LogLevel, std::string_view line) override {
+        // line: "<writer> <seq>"
+        const auto space = line.find(' ');
+        const int writer = std::stoi(std::string(line.substr(0, space)));
+        const long seq = std::stol(std::string(line.substr(space + 1)));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (seq != m_next[writer]) ++m_outOfOrder;
+        m_next[writer] = seq + 1;
+        ++m_lines;
+    }
+
+    long outOfOrder() { std::lock_guard<std::mutex> lock(m_mutex); return m_outOfOrder; }
+    long lines() { std::lock_guard<std::mutex> lock(m_mutex); return m_lines; }
+
+private:
+    std::mutex m_mutex;
+    std::vector<long> m_next;
+    long m_outOfOrder = 0;
+    long m_lines = 0;
+};
+
+} // namespace
+
+int main() {
+    constexpr int kWriters = 4;
+    constexpr int kRounds = 200;
+    constexpr int kBurst = 300;   // more than the backend takes from one ring per pass
+
+    Logger a;
+    Logger b;
+    auto sinkA = std::make_shared<OrderSink>(kWriters);
+    auto sinkB = std::make_shared<OrderSink>(kWriters);
+    for (auto [logger, sink] : { std::pair{ &a, sinkA }, std::pair{ &b, sinkB } }) {
+        logger->enableConsoleOutput(false);
+        logger->enableFileOutput(false);
+        logger->setPattern("%v");
+        logger->addSink(sink);
+        logger->enableAsync(true, LogQueueMode::PerThread);
+    }
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            long seqA = 0;
+            long seqB = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                for (int i = 0; i < kBurst; ++i) a.log(LogLevel::INFO, "", w, " ", seqA++);
+                b.log(LogLevel::INFO, "", w, " ", seqB++);
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+    a.flush();
+    b.flush();
+
+    int failures = 0;
+    auto expect = [&](bool ok, const char* what, long value) {
+        std::printf("%-36s %ld %s\n", what, value, ok ? "ok" : "FAILED");
+        if (!ok) ++failures;
+    };
+    expect(sinkA->lines() == long{ kWriters } * kRounds * kBurst, "logger A lines:", sinkA->lines());
+    expect(sinkA->outOfOrder() == 0, "logger A lines out of order:", sinkA->outOfOrder());
+    expect(sinkB->lines() == long{ kWriters } * kRounds, "logger B lines:", sinkB->lines());
+    expect(sinkB->outOfOrder() == 0, "logger B lines out of order:", sinkB->outOfOrder());
+    a.shutdown();
+    b.shutdown();
+    std::printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// LogRingSink keeps the last N lines: overfilled, snapshot() returns exactly the newest N,
+// oldest first, with long lines cut to the slot size. Snapshots taken while threads write are
+// never torn and keep each thread's lines in order; behind an async logger the ring gets the
+// lines at its own level.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void check(const char* what, bool ok) {
+    std::printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) ++g_failures;
+}
+
+std::vector<std::string> numbered(int from, int to) {
+    std::vector<std::string> lines;
+    for (int i = from; i < to; ++i) lines.push_back("line " + std::to_string(i));
+    return lines;
+}
+
+void overfill() {
+    LogRingSink ring(8);
+    for (int i = 0; i < 5; ++i) ring.write(LogLevel::INFO, "line " + std::to_string(i));
+    check("partly filled ring in write order", ring.snapshot() == numbered(0, 5));
+
+    for (int i = 5; i < 21; ++i) ring.write(LogLevel::INFO, "line " + std::to_string(i));
+    check("overfilled ring keeps the newest lines, oldest first", ring.snapshot() == numbered(13, 21) && ring.written() == 21);
+
+    // Wrapping an exact multiple of the capacity
+    for (int i = 21; i < 29; ++i) ring.write(LogLevel::INFO, "line " + std::to_string(i));
+    check("full turn of the ring", ring.snapshot() == numbered(21, 29));
+
+    ring.clear();
+    ring.write(LogLevel::INFO, "after clear");
+    check("clear() empties the ring", ring.snapshot() == std::vector<std::string>{ "after clear" } && ring.written() == 1);
+}
+
+void longLines() {
+    LogRingSink ring(2, 16);
+    ring.write(LogLevel::INFO, std::string(40, 'a'));
+    ring.write(LogLevel::INFO, "short");
+    ring.write(LogLevel::INFO, std::string(16, 'b'));
+    check("lines cut to the slot size", ring.snapshot() == std::vector<std::string>{ "short", std::string(16, 'b') });
+}
+
+// Lines "<thread> <seq>" padded to full slots, so a torn copy would show mixed content
+void concurrent() {
+    constexpr int kThreads = 4;
+    constexpr int kLines = 20000;
+    LogRingSink ring(64, 64);
+    std::atomic<bool> done{ false };
+    bool ordered = true, whole = true, bounded = true;
+
+    std::thread reader([&] {
+        while (!done.load()) {
+            const std::vector<std::string> lines = ring.snapshot();
+            bounded = bounded && lines.size() <= 64;
+            std::vector<int> last(kThreads, -1);
+            for (const std::string& text : lines) {
+                // "<t> <i> " and then only the thread's padding letter
+                int t = -1, i = -1;
+                if (std::sscanf(text.c_str(), "%d %d", &t, &i) != 2 || t < 0 || t >= kThreads || text.size() != 64 ||
+                    text.find_first_not_of(static_cast<char>('a' + t), text.find(' ', 2) + 1) != std::string::npos) {
+                    whole = false;
+                    continue;
+                }
+                ordered = ordered && i > last[t];
+                last[t] = i;
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < kLines; ++i) {
+                std::string text = std::to_string(t) + " " + std::to_string(i) + " ";
+                text.resize(64, static_cast<char>('a' + t));
+                ring.write(LogLevel::INFO, text);
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
+    done = true;
+    reader.join();
+    check("snapshots while threads write: whole lines, in order per thread",
+        ordered && whole && bounded && ring.written() == static_cast<std::uint64_t>(kThreads) * kLines);
+}
+
+void behindLogger() {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.setPattern("%v");
+    logger.setLogLevel(LogLevel::DEBUG);
+    auto ring = std::make_shared<LogRingSink>(4);
+    logger.addSink(ring, LogLevel::WARN);
+    logger.enableAsync(true);
+    for (int i = 0; i < 10; ++i) {
+        logger.log(LogLevel::INFO, "ring", "below the sink's level");
+        logger.log(LogLevel::WARN, "ring", "line ", i);
+    }
+    logger.flush();
+    check("async logger into the ring, filtered by the sink's level", ring->snapshot() == numbered(6, 10));
+    logger.shutdown();
+}
+
+} // namespace
+
+int main() {
+    overfill();
+    longLines();
+    concurrent();
+    behindLogger();
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Size rotation under load: several threads log while files rotate every few kilobytes, and
+// the renames of the backup chain run on the maintenance thread. After close() the chain must
+// be complete: the configured number of backups, no temporary files, no file over the size
+// limit, and every line exactly once and in order per thread (when all backups are kept).
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+constexpr int kThreads = 4;
+constexpr int kLines = 5000;
+constexpr std::uint64_t kMaxFileSize = 4096;
+
+void fail(const char* what, const std::string& detail) {
+    std::printf("%s: %s\n", what, detail.c_str());
+    ++g_failures;
+}
+
+// Logs kThreads x kLines lines "<thread> <seq>" and closes the logger
+void logUnderLoad(const std::filesystem::path& path, int backups, bool async) {
+    Logger logger;
+    logger.enableConsoleOutput(false);
+    logger.setPattern("%v");
+    LogRotationPolicy policy;
+    policy.maxFileSize = kMaxFileSize;
+    policy.maxBackups = backups;
+    logger.fileSink()->setRotationPolicy(policy);
+    logger.setLogPath(path);
+    if (async) logger.enableAsync(true);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < kLines; ++i) logger.log(LogLevel::INFO, "writer", t, ' ', i);
+        });
+    }
+    for (auto& w : writers) w.join();
+    logger.shutdown();
+    logger.fileSink()->close();     // waits for the maintenance thread
+}
+
+// Reads the chain oldest first (app.log.N ... app.log.1, app.log) and checks every line;
+// returns the number of backups
+int checkChain(const char* what, const std::filesystem::path& path, bool complete) {
+    const std::filesystem::path dir = path.parent_path();
+    int backups = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const std::string name = entry.path().filename().string();
+        if (name == path.filename().string()) continue;
+        if (name.rfind("app.log.", 0) != 0 || name.find_first_not_of("0123456789", 8) != std::string::npos) {
+            fail(what, "unexpected file " + name);
+            continue;
+        }
+        ++backups;
+    }
+
+    std::vector<int> next(kThreads, -1);   // last sequence number seen per thread
+    std::set<std::pair<int, int>> seen;
+    for (int index = backups; index >= 0; --index) {
+        const std::filesystem::path file = index == 0 ? path : std::filesystem::path(path.string() + "." + std::to_string(index));
+        if (!std::filesystem::exists(file)) {
+            fail(what, "missing " + file.filename().string());
+            continue;
+        }
+        if (std::filesystem::file_size(file) > kMaxFileSize) fail(what, file.filename().string() + " is over the size limit");
+        std::ifstream in(file);
+        std::string text;
+        while (std::getline(in, text)) {
+            int t = -1, i = -1;
+            if (std::sscanf(text.c_str(), "%d %d", &t, &i) != 2 || t < 0 || t >= kThreads || i < 0 || i >= kLines) {
+                fail(what, "garbled line \"" + text + "\"");
+                continue;
+            }
+            if (i <= next[t]) fail(what, "out of order: " + text);
+            if (complete && i != next[t] + 1) fail(what, "missing lines before " + text);
+            next[t] = i;
+            seen.insert({ t, i });
+        }
+    }
+    if (complete && seen.size() != static_cast<std::size_t>(kThreads) * kLines)
+        fail(what, std::to_string(seen.size()) + " distinct lines");
+    return backups;
+}
+
+void run(bool async) {
+    const int failuresBefore = g_failures;
+    const char* what = async ? "async" : "sync";
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_rotation_load_test";
+    const std::filesystem::path path = dir / "app.log";
+
+    // Room for every backup: nothing may be lost or duplicated by the background renames
+    std::filesystem::remove_all(dir);
+    logUnderLoad(path, 1000, async);
+    checkChain(what, path, /*complete=*/true);
+
+    // Three backups: older files are dropped, exactly three remain
+    std::filesystem::remove_all(dir);
+    logUnderLoad(path, 3, async);
+    const int backups = checkChain(what, path, /*complete=*/false);
+    if (backups != 3) fail(what, std::to_string(backups) + " backups, expected 3");
+
+    std::filesystem::remove_all(dir);
+    std::printf("%s: %s\n", what, g_failures == failuresBefore ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    run(false);
+    run(true);
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+// Size rotation counts bytes instead of asking the file system: a file is filled exactly up to
+// maxFileSize and the line that would cross it starts the next file; a single line longer than
+// the limit gets a file of its own. Checked with every file backend, also when a backend
+// switch continues a file that already has content.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+int g_failures = 0;
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+void expectFile(const char* backend, const std::filesystem::path& path, const std::string& expected) {
+    const std::string content = readFile(path);
+    if (content == expected) return;
+    std::printf("%s: %s has %zu bytes, expected %zu\n", backend, path.filename().string().c_str(), content.size(), expected.size());
+    ++g_failures;
+}
+
+// Nine characters and the newline: ten bytes per line
+std::string line(int i) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "line %04d", i);
+    return text;
+}
+
+void run(LogFileBackend backend, const char* name) {
+    const int failuresBefore = g_failures;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_rotation_size_test";
+    std::filesystem::remove_all(dir);
+    const std::filesystem::path path = dir / "app.log";
+
+    LogFileSink sink(backend);
+    LogRotationPolicy policy;
+    policy.maxFileSize = 100;
+    policy.maxBackups = 5;
+    sink.setRotationPolicy(policy);
+    sink.open(path);
+
+    // Exactly 100 bytes: no rotation yet; the eleventh line starts app.log
+    std::string first, second;
+    for (int i = 0; i < 10; ++i) {
+        sink.write(LogLevel::INFO, line(i));
+        first += line(i) + "\n";
+    }
+    sink.write(LogLevel::INFO, line(10));
+    second = line(10) + "\n";
+
+    // 251 bytes: closes the current file before it and is followed by a new file at once
+    const std::string longLine(250, 'x');
+    sink.write(LogLevel::INFO, longLine);
+    sink.write(LogLevel::INFO, line(11));
+    sink.close();
+
+    expectFile(name, dir / "app.log.3", first);
+    expectFile(name, dir / "app.log.2", second);
+    expectFile(name, dir / "app.log.1", longLine + "\n");
+    expectFile(name, path, line(11) + "\n");
+
+    // Appending: the count starts from the size of the existing file. A backend switch
+    // continues the open file, so after it nine more lines fill it to the limit and the
+    // tenth rotates.
+    std::string appended = line(11) + "\n";
+    {
+        LogFileSink again(LogFileBackend::Stream);
+        again.setRotationPolicy(policy);
+        again.open(path);
+        again.write(LogLevel::INFO, line(11));
+        again.setBackend(backend == LogFileBackend::Stream ? LogFileBackend::Posix : backend);
+        for (int i = 12; i < 21; ++i) {
+            again.write(LogLevel::INFO, line(i));
+            appended += line(i) + "\n";
+        }
+        again.write(LogLevel::INFO, line(21));
+        again.close();
+    }
+    expectFile(name, dir / "app.log.1", appended);
+    expectFile(name, path, line(21) + "\n");
+
+    std::filesystem::remove_all(dir);
+    std::printf("%s: %s\n", name, g_failures == failuresBefore ? "ok" : "FAILED");
+}
+
+} // namespace
+
+int main() {
+    run(LogFileBackend::Stream, "stream");
+    run(LogFileBackend::Posix, "posix");
+    run(LogFileBackend::Mmap, "mmap");
+    run(LogFileBackend::Uring, "uring");
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+// Time rotation: with one-second periods and a file name pattern down to the second, lines
+// written over a few seconds must each land in the file named after the second in which they
+// were written, none lost or doubled, in order across the files. An hourly pattern gets the
+// current hour's name.
+// Build and run: see tests/README.md
+#include "../loggy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+void fail(const char* what, const std::string& detail) {
+    std::printf("%s: %s\n", what, detail.c_str());
+    ++g_failures;
+}
+
+struct Stamp {
+    std::string second;     // HHMMSS, local time
+    int millis;
+};
+
+Stamp stamp(std::chrono::system_clock::time_point when) {
+    const std::tm tm = loggy_detail::localTime(std::chrono::system_clock::to_time_t(when));
+    char text[16];
+    std::strftime(text, sizeof(text), "%H%M%S", &tm);
+    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(when.time_since_epoch()).count() % 1000;
+    return { text, static_cast<int>(millis) };
+}
+
+void perSecond() {
+    const char* what = "per-second files";
+    const int failuresBefore = g_failures;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_time_rotation_test";
+    std::filesystem::remove_all(dir);
+
+    // Lines "<HHMMSS> <millis> <seq>" with the time taken right before the write
+    int count = 0;
+    {
+        LogFileSink sink;
+        sink.setTimeRotation(std::chrono::seconds(1));
+        sink.open(dir / "app-%H%M%S.log");
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(3200);
+        while (std::chrono::steady_clock::now() < end) {
+            const Stamp now = stamp(std::chrono::system_clock::now());
+            sink.write(LogLevel::INFO, now.second + " " + std::to_string(now.millis) + " " + std::to_string(count++));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        sink.close();
+    }
+
+    struct File {
+        std::string second;
+        std::vector<int> lines;
+    };
+    std::vector<File> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() != 14 || name.rfind("app-", 0) != 0 || name.substr(10) != ".log") {
+            fail(what, "unexpected file " + name);
+            continue;
+        }
+        File file{ name.substr(4, 6), {} };
+        std::ifstream in(entry.path());
+        char second[16];
+        int millis = -1, seq = -1;
+        std::string text;
+        while (std::getline(in, text)) {
+            if (std::sscanf(text.c_str(), "%15s %d %d", second, &millis, &seq) != 3) {
+                fail(what, "garbled line \"" + text + "\" in " + name);
+                continue;
+            }
+            // The rotation looks at the clock a moment after the test did: a line stamped in
+            // the last millisecond of a second may already go into the next second's file
+            if (second != file.second && !(millis == 999 && file.lines.empty()))
+                fail(what, "line \"" + text + "\" in " + name);
+            file.lines.push_back(seq);
+        }
+        if (file.lines.empty()) fail(what, name + " is empty");
+        else files.push_back(std::move(file));
+    }
+
+    // Sorted by their first line (the names wrap at midnight), the files hold 0..count-1
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.lines.front() < b.lines.front(); });
+    int next = 0;
+    for (const File& file : files) {
+        for (int seq : file.lines) {
+            if (seq != next) fail(what, "line " + std::to_string(seq) + " in app-" + file.second + ".log, expected " + std::to_string(next));
+            next = seq + 1;
+        }
+    }
+    if (next != count) fail(what, std::to_string(next) + " lines, expected " + std::to_string(count));
+    if (files.size() < 3) fail(what, std::to_string(files.size()) + " files in 3.2 seconds");
+
+    std::filesystem::remove_all(dir);
+    std::printf("%s: %s\n", what, g_failures == failuresBefore ? "ok" : "FAILED");
+}
+
+void hourlyName() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "loggy_time_rotation_test";
+    std::filesystem::remove_all(dir);
+    const std::time_t before = std::time(nullptr);
+    {
+        LogFileSink sink;
+        sink.setTimeRotation(LogRotateInterval::Hourly);
+        sink.open(dir / "app-%Y%m%d-%H.log");
+        sink.write(LogLevel::INFO, "line");
+        sink.close();
+    }
+    const std::time_t after = std::time(nullptr);
+
+    // The hour may change between the two clock reads: either name is right then
+    bool ok = false;
+    for (std::time_t t : { before, after }) {
+        const std::tm tm = loggy_detail::localTime(t);
+        char name[32];
+        std::strftime(name, sizeof(name), "app-%Y%m%d-%H.log", &tm);
+        ok = ok || std::filesystem::exists(dir / name);
+    }
+    std::printf("hourly file named after the current hour: %s\n", ok ? "ok" : "FAILED");
+    if (!ok) ++g_failures;
+    std::filesystem::remove_all(dir);
+}
+
+} // namespace
+
+int main() {
+    perSecond();
+    hourlyName();
+    std::printf(g_failures ? "FAILED\n" : "OK\n");
+    return g_failures ? 1 : 0;
+}